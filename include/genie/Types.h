@@ -63,6 +63,51 @@ enum GameVersion
 const GameVersion GV_LatestTap = GV_T8;
 const GameVersion GV_LatestDE2 = GV_C27;
 
+//------------------------------------------------------------------------------
+/// Game version known to lie within [First, Last]. Compares like a
+/// GameVersion, but comparisons that give the same result for the whole
+/// range are constant, so serializers instantiated per range lose the
+/// branches that can't be taken there.
+//
+template <GameVersion First, GameVersion Last>
+class GameVersionRange
+{
+public:
+  constexpr explicit GameVersionRange(GameVersion gv) : gv_(gv)
+  {
+  }
+
+  constexpr bool operator<(GameVersion v) const
+  {
+    return v > Last || (v > First && gv_ < v);
+  }
+
+  constexpr bool operator<=(GameVersion v) const
+  {
+    return v >= Last || (v >= First && gv_ <= v);
+  }
+
+  constexpr bool operator>(GameVersion v) const
+  {
+    return v < First || (v < Last && gv_ > v);
+  }
+
+  constexpr bool operator>=(GameVersion v) const
+  {
+    return v <= First || (v <= Last && gv_ >= v);
+  }
+
+private:
+  GameVersion gv_;
+};
+
+// Families of versions sharing a file layout, in order.
+typedef GameVersionRange<GV_None, GV_RoR> AoEVersions;
+typedef GameVersionRange<GV_Tapsa, GV_LatestTap> TapsaVersions;
+typedef GameVersionRange<GV_AoKE3, GV_Cysion> AoKVersions;
+typedef GameVersionRange<GV_C2, GV_LatestDE2> DE2Versions;
+typedef GameVersionRange<GV_SWGB, GV_CCV2> SWGBVersions;
+
 struct XYZF
 {
   float x, y, z;
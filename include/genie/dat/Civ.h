@@ -20,6 +20,8 @@
 
 #ifndef GENIE_CIV_H
 #define GENIE_CIV_H
+#include <memory>
+
 #include "genie/file/ISerializable.h"
 #include "Unit.h"
 
@@ -62,10 +64,30 @@ public:
   /// Units defined for this civ.
   std::vector<Unit> Units;
 
+  /// Units defined for this civ if the dat was loaded with
+  /// DatFile::setShareUnits, Units is empty then. Equal units of all civs
+  /// point to the same object, so change them through editUnit() only.
+  std::vector<std::shared_ptr<Unit>> SharedUnits;
+
+  /// Number of units, shared or not.
+  size_t getUnitCount(void) const;
+
+  /// Unit from Units or SharedUnits.
+  const Unit &getUnit(size_t index) const;
+
+  /// Unit for changing it. A shared unit is copied first, so the other civs
+  /// keep theirs.
+  Unit &editUnit(size_t index);
+
+  /// Copies shared units into Units.
+  void unshareUnits(void);
+
   std::vector<int16_t> UniqueUnitsTechs = {-1, -1, -1, -1}; // Unknown in >=SWGB (cnt=4)
 
 private:
   virtual void serializeObject(void);
+
+  void serializeSharedUnits(size_t count);
 };
 
 }
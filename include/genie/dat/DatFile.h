@@ -23,6 +23,7 @@
 
 #include <string>
 #include <iostream>
+#include <memory>
 
 #include "genie/Types.h"
 #include "genie/file/IFile.h"
@@ -50,6 +51,32 @@ namespace genie
 class DatFile : public IFile
 {
 public:
+  //----------------------------------------------------------------------------
+  /// Top level sections of a dat file, to select which ones are loaded.
+  //
+  struct Sections
+  {
+    enum : uint32_t
+    {
+      TerrainRestrictions = 0x0001,
+      PlayerColours       = 0x0002,
+      Sounds              = 0x0004,
+      Graphics            = 0x0008,
+      TerrainBlock        = 0x0010,
+      RandomMaps          = 0x0020,
+      Effects             = 0x0040,
+      UnitLines           = 0x0080,
+      UnitHeaders         = 0x0100,
+      Civs                = 0x0200,
+      Techs               = 0x0400,
+      TechTree            = 0x0800,
+      All                 = 0xFFFFFFFF
+    };
+
+    /// Number of single section flags.
+    static const unsigned int COUNT = 12;
+  };
+
   //----------------------------------------------------------------------------
   /// Standard constructor
   //
@@ -65,11 +92,92 @@ public:
   //----------------------------------------------------------------------------
   virtual void setGameVersion(GameVersion gv);
 
+  using IFile::load;
+
+  //----------------------------------------------------------------------------
+  /// Loads only the given sections of a dat file. Sets the load mask used
+  /// by later loads too, see setLoadSections.
+  ///
+  /// @param fileName file name
+  /// @param sections Sections flags to load
+  //
+  void load(const char *fileName, uint32_t sections);
+
+  //----------------------------------------------------------------------------
+  /// Selects the sections read by load() and loadMapped(). Skipped sections
+  /// are parsed past into one scratch object each. Their vectors are left
+  /// empty and single objects like TerrainBlock are reset to default ones. A
+  /// file loaded partially should not be saved.
+  ///
+  /// @param sections Sections flags to load, Sections::All by default
+  //
+  inline void setLoadSections(uint32_t sections) { load_sections_ = sections; }
+  inline uint32_t getLoadSections(void) const { return load_sections_; }
+
+  //----------------------------------------------------------------------------
+  /// Offset of a section in the inflated data of the last load, as found
+  /// before its first record. Used to build a DatIndex.
+  ///
+  /// @param section single Sections flag
+  /// @return offset or UINT32_MAX if the section was not read
+  //
+  uint32_t getSectionOffset(uint32_t section) const;
+
+  //----------------------------------------------------------------------------
+  /// Game version set before the last load. Loading may resolve it to a
+  /// later version, which getGameVersion() returns.
+  //
+  inline GameVersion getLoadVersion(void) const { return load_version_; }
+
+  //----------------------------------------------------------------------------
+  /// Saves the loaded data uncompressed, tagged with the size and checksum of
+  /// the dat file it was loaded from and the game version. Loading it back
+  /// skips inflating the dat. Needs all sections to be loaded.
+  ///
+  /// @param fileName snapshot file name
+  /// @exception std::ios_base::failure thrown if the dat file can't be read
+  ///                                   or the snapshot can't be written
+  //
+  void saveSnapshot(const char *fileName);
+
+  //----------------------------------------------------------------------------
+  /// Loads a snapshot saved by saveSnapshot() if it still matches its dat
+  /// file and the set game version. Afterwards the object is the same as if
+  /// the dat file was loaded.
+  ///
+  /// @param fileName snapshot file name
+  /// @param datFileName dat file the snapshot was made of
+  /// @return false if the snapshot is missing, incomplete or stale, nothing
+  ///         is loaded then
+  /// @exception std::ios_base::failure thrown if the snapshot is damaged
+  //
+  bool loadSnapshot(const char *fileName, const char *datFileName);
+
+  //----------------------------------------------------------------------------
+  /// Loads a dat file through its snapshot, see getSnapshotName(). If there
+  /// is no valid snapshot the dat is loaded and a snapshot is saved for the
+  /// next time, if possible.
+  ///
+  /// @param fileName dat file name
+  /// @exception std::ios_base::failure thrown if the dat file can't be read
+  //
+  void loadCached(const char *fileName);
+
+  //----------------------------------------------------------------------------
+  /// File name of the snapshot belonging to a dat file.
+  //
+  static std::string getSnapshotName(const char *datFileName);
+
   //----------------------------------------------------------------------------
   /// Uncompress dat file.
   //
   void extractRaw(const char *inFile, const char *outFile);
 
+  //----------------------------------------------------------------------------
+  /// Saves through one pre-sized buffer, see IFile::saveBuffered.
+  //
+  void saveAs(const char *fileName) override;
+
   //----------------------------------------------------------------------------
   /// Debug information will be printed to stdout if activated.
   ///
@@ -77,6 +185,26 @@ public:
   //
   void setVerboseMode(bool verbose);
 
+  //----------------------------------------------------------------------------
+  /// Number of threads writing sections when saving through saveAs(). Each
+  /// section, and each civ, is written into its own buffer and the buffers
+  /// are joined in file order, so the file is the same as a serial save.
+  /// The sections are written on WorkerPool::getGlobalPool().
+  ///
+  /// @param count 1 to save serially (default), 0 for one per core
+  //
+  void setSaveThreadCount(unsigned int count);
+
+  //----------------------------------------------------------------------------
+  /// Loads the units of all civs into Civ::SharedUnits, keeping equal units
+  /// only once. Saved files stay the same. Civs with shared units are saved
+  /// on one thread, as their units may be shared with other civs.
+  ///
+  /// @param share true to share units on the next load
+  //
+  inline void setShareUnits(bool share) { share_units_ = share; }
+  inline bool getShareUnits(void) const { return share_units_; }
+
   // File data
   static const unsigned short FILE_VERSION_SIZE = 8;
   std::string FileVersion;
@@ -137,12 +265,174 @@ private:
 
   Compressor compressor_;
 
+  unsigned int save_threads_ = 1;
+  bool share_units_ = false;
+  uint32_t load_sections_ = Sections::All;
+  GameVersion load_version_ = GV_None;
+  std::vector<uint32_t> section_offsets_;
+
+  /// Sections waiting to be written by the save threads.
+  struct SectionQueue;
+  std::unique_ptr<SectionQueue> sections_;
+
   //----------------------------------------------------------------------------
   /// Clears all data.
   //
   virtual void unload(void);
 
   virtual void serializeObject(void);
+
+  //----------------------------------------------------------------------------
+  /// Starts queueing sections if saving into a buffer on several threads.
+  //
+  void beginSections(void);
+
+  //----------------------------------------------------------------------------
+  /// Writes the queued sections and joins them into the output.
+  //
+  void endSections(void);
+
+  //----------------------------------------------------------------------------
+  /// Queues objects to be written as one section, following everything
+  /// serialized so far.
+  //
+  void queueSection(std::vector<ISerializable *> objects);
+
+  //----------------------------------------------------------------------------
+  /// Remembers the offset of a section while reading.
+  //
+  void markSection(uint32_t section);
+
+  //----------------------------------------------------------------------------
+  /// Whether a section is skipped by the current read.
+  //
+  inline bool skipsSection(uint32_t section)
+  {
+    return isOperation(OP_READ) && !(load_sections_ & section);
+  }
+
+  //----------------------------------------------------------------------------
+  /// Reads an object into a scratch object which is dropped afterwards.
+  //
+  template <typename T>
+  void skipSub(T &scratch)
+  {
+    scratch.setGameVersion(getGameVersion());
+    serialize<ISerializable>(scratch);
+  }
+
+  //----------------------------------------------------------------------------
+  /// Like serializeSub, but queues the objects if sections are written in
+  /// parallel. With one_each every object gets its own section.
+  //
+  template <typename T>
+  void serializeSection(uint32_t section, std::vector<T> &vec, size_t size,
+                        bool one_each = false)
+  {
+    markSection(section);
+
+    if (skipsSection(section))
+    {
+      std::vector<T>().swap(vec);
+
+      T scratch;
+      for (size_t i = 0; i < size; ++i)
+        skipSub(scratch);
+
+      return;
+    }
+
+    if (!sections_)
+    {
+      serializeSub<T>(vec, size);
+      return;
+    }
+
+    if (vec.size() != size)
+      std::cerr << "Warning!: vector size differs size!" << vec.size() << " " << size <<  std::endl;
+
+    std::vector<ISerializable *> objects;
+
+    for (T &data : vec)
+    {
+      if (one_each)
+        queueSection({&data});
+      else
+        objects.push_back(&data);
+    }
+
+    if (!one_each)
+      queueSection(objects);
+  }
+
+  //----------------------------------------------------------------------------
+  /// Like serializeSubWithPointers, but queues the objects if sections are
+  /// written in parallel.
+  //
+  template <typename T>
+  void serializeSectionWithPointers(uint32_t section, std::vector<T> &vec,
+                                    size_t size, std::vector<int32_t> &pointers)
+  {
+    markSection(section);
+
+    if (skipsSection(section))
+    {
+      std::vector<T>().swap(vec);
+
+      T scratch;
+      for (size_t i = 0; i < size; ++i)
+      {
+        if (pointers[i])
+          skipSub(scratch);
+      }
+
+      return;
+    }
+
+    if (!sections_)
+    {
+      serializeSubWithPointers<T>(vec, size, pointers);
+      return;
+    }
+
+    std::vector<ISerializable *> objects;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+      if (pointers[i])
+        objects.push_back(&vec[i]);
+    }
+
+    queueSection(objects);
+  }
+
+  //----------------------------------------------------------------------------
+  /// Like serialize<ISerializable>, but queues the object if sections are
+  /// written in parallel.
+  //
+  template <typename T>
+  void serializeSection(uint32_t section, T &data)
+  {
+    markSection(section);
+
+    if (skipsSection(section))
+    {
+      // Drop what an earlier load left, like the vector sections do.
+      data = T();
+      data.setGameVersion(getGameVersion());
+
+      T scratch;
+      skipSub(scratch);
+    }
+    else if (sections_)
+    {
+      queueSection({&data});
+    }
+    else
+    {
+      serialize<ISerializable>(data);
+    }
+  }
 };
 
 }
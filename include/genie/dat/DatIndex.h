@@ -0,0 +1,149 @@
+/*
+    geniedat - A library for reading and writing data files of genie
+               engine games.
+    Copyright (C) 2011 - 2013  Armin Preiml
+    Copyright (C) 2011 - 2021  Mikko "Tapsa" P
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GENIE_DATINDEX_H
+#define GENIE_DATINDEX_H
+
+#include <string>
+#include <vector>
+
+#include "genie/file/IFile.h"
+#include "DatFile.h"
+
+namespace genie
+{
+
+//------------------------------------------------------------------------------
+/// Offsets of the sections and records of a dat file, saved next to it so
+/// that single records can be read without parsing the whole file.
+///
+/// Offsets point into the inflated data of the dat (see DatFile::extractRaw),
+/// as deflate streams can't be seeked. The index is tied to the dat by its
+/// size and checksum and has to be rebuilt when the dat changes.
+//
+class DatIndex : public IFile
+{
+public:
+  /// Marks sections that were not read and records that don't exist.
+  static const uint32_t NO_OFFSET = 0xFFFFFFFF;
+
+  DatIndex();
+  virtual ~DatIndex();
+
+  /// Checksum (crc32) and size of the dat file the index belongs to.
+  uint32_t DatHash = 0;
+  uint32_t DatSize = 0;
+
+  /// Game version set before loading the dat and the one it resolved to.
+  GameVersion LoadVersion = GV_None;
+  GameVersion DatVersion = GV_None;
+
+  /// Offset of each top level section, indexed by the bit number of its
+  /// DatFile::Sections flag. NO_OFFSET for sections that were not read, their
+  /// records are NO_OFFSET too.
+  std::vector<uint32_t> SectionOffsets;
+
+  std::vector<uint32_t> CivOffsets;
+
+  /// Units per civ, NO_OFFSET for empty unit slots.
+  std::vector<std::vector<uint32_t>> UnitOffsets;
+
+  /// NO_OFFSET for empty graphic slots.
+  std::vector<uint32_t> GraphicOffsets;
+
+  std::vector<uint32_t> TechOffsets;
+
+  //----------------------------------------------------------------------------
+  /// Fills the index from a dat file that was just loaded.
+  ///
+  /// @exception std::ios_base::failure thrown if the dat file can't be read
+  //
+  void build(DatFile &dat);
+
+  //----------------------------------------------------------------------------
+  /// Loads the index saved next to a dat file.
+  ///
+  /// @param datFileName file name of the dat
+  /// @param gv game version the dat would be loaded with
+  /// @return false if there is no index or it belongs to another version of
+  ///         the dat or was built for another game version
+  //
+  bool loadFor(const char *datFileName, GameVersion gv);
+
+  //----------------------------------------------------------------------------
+  /// Builds the index for a loaded dat file and saves it next to it.
+  //
+  void saveFor(DatFile &dat);
+
+  //----------------------------------------------------------------------------
+  /// File name of the index belonging to a dat file.
+  //
+  static std::string getSidecarName(const char *datFileName);
+
+  //----------------------------------------------------------------------------
+  /// Checksum of a whole file, as stored in DatHash.
+  ///
+  /// @exception std::ios_base::failure thrown if the file can't be read
+  //
+  static uint32_t hashFile(const char *fileName, uint32_t *size = 0);
+
+  //----------------------------------------------------------------------------
+  /// Offset of a section.
+  ///
+  /// @param section single DatFile::Sections flag
+  //
+  uint32_t getSectionOffset(uint32_t section) const;
+
+  //----------------------------------------------------------------------------
+  /// Reads one record from inflated dat data.
+  ///
+  /// @param data inflated dat data
+  /// @param size size of data
+  /// @param offset offset of the record, like getUnitOffset(12, 4)
+  /// @param record object to read into
+  /// @exception std::ios_base::failure thrown if offset is out of the data
+  //
+  template <typename T>
+  void readRecord(const char *data, size_t size, uint32_t offset, T &record) const
+  {
+    if (offset == NO_OFFSET || offset >= size)
+      throw std::ios_base::failure("Record offset out of dat data");
+
+    ReadBuffer buffer(data + offset, data + size);
+
+    record.setGameVersion(DatVersion);
+    record.readObject(buffer);
+  }
+
+  uint32_t getCivOffset(size_t civ) const;
+  uint32_t getUnitOffset(size_t civ, size_t unit) const;
+  uint32_t getGraphicOffset(size_t graphic) const;
+  uint32_t getTechOffset(size_t tech) const;
+
+private:
+  virtual void serializeObject(void);
+
+  //----------------------------------------------------------------------------
+  static uint32_t getOffset(const std::vector<uint32_t> &offsets, size_t i);
+};
+
+}
+
+#endif // GENIE_DATINDEX_H
@@ -114,6 +114,14 @@ public:
 
 private:
   virtual void serializeObject(void);
+
+  friend class ISerializable;
+
+  //----------------------------------------------------------------------------
+  /// Compiled once per game family, see ISerializable::serializeByFamily.
+  //
+  template <class Versions>
+  void serializeVersioned(Versions gv);
 };
 
 }
@@ -31,16 +31,42 @@ class TerrainRestriction : public ISerializable
 {
 public:
   TerrainRestriction();
+
+  //----------------------------------------------------------------------------
+  /// Creates a restriction sized for the given terrain count, like
+  /// TerrainRestriction(dat.TerrainsUsed1) for a new record of a dat.
+  //
+  explicit TerrainRestriction(unsigned short terrainCount);
+
   virtual ~TerrainRestriction();
   virtual void setGameVersion(GameVersion gv);
 
+  //----------------------------------------------------------------------------
+  /// Sets the terrain count used when serialized outside of a DatFile, and
+  /// resizes the vectors to it. Restrictions read or written by a DatFile
+  /// take its count.
+  //
+  void setTerrainCount(unsigned short cnt);
+
+  //----------------------------------------------------------------------------
+  /// @return terrain count of this object, -1 if not set yet
+  //
+  inline int getTerrainCount(void) const { return terrain_count_; }
+
   std::vector<float> PassableBuildableDmgMultiplier;
   std::vector<TerrainPassGraphic> TerrainPassGraphics;
 
-  static void setTerrainCount(unsigned short cnt);
-
 private:
-  static unsigned short terrain_count_;
+  int terrain_count_ = -1;
+
+  //----------------------------------------------------------------------------
+  /// Terrain count passed by the DatFile being serialized, else the count of
+  /// this object. Restrictions without a count are sized on their first
+  /// DatFile save.
+  ///
+  /// @exception std::ios_base::failure thrown if no count is known
+  //
+  unsigned short serializedTerrainCount(void);
 
   virtual void serializeObject(void);
 };
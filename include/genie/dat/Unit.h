@@ -281,6 +281,14 @@ public:
 
 protected:
   virtual void serializeObject(void);
+
+  friend class ISerializable;
+
+  //----------------------------------------------------------------------------
+  /// Compiled once per game family, see ISerializable::serializeByFamily.
+  //
+  template <class Versions>
+  void serializeVersioned(Versions gv);
 };
 
 }
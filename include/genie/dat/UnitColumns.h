@@ -0,0 +1,100 @@
+/*
+    geniedat - A library for reading and writing data files of genie
+               engine games.
+    Copyright (C) 2011 - 2013  Armin Preiml
+    Copyright (C) 2011 - 2021  Mikko "Tapsa" P
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GENIE_UNITCOLUMNS_H
+#define GENIE_UNITCOLUMNS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "DatFile.h"
+
+namespace genie
+{
+
+//------------------------------------------------------------------------------
+/// Copy of often scanned unit fields of all civs, one contiguous array per
+/// field. Row i of every column belongs to the same unit, so filters and
+/// sums over a column run over plain arrays instead of whole Unit objects.
+///
+/// Lists like costs and attacks are stored flat: the entries of row i are
+/// rows CostBegin[i] to CostBegin[i + 1] of the Cost columns, and likewise
+/// for attacks and armours.
+///
+/// The columns are a snapshot, later changes to the dat are not reflected.
+//
+class UnitColumns
+{
+public:
+  UnitColumns();
+  virtual ~UnitColumns();
+
+  //----------------------------------------------------------------------------
+  /// Fills the columns with the existing units of all civs of a dat, by civ
+  /// and then by unit id. Empty unit slots are left out.
+  //
+  void build(const DatFile &dat);
+
+  //----------------------------------------------------------------------------
+  /// Number of units.
+  //
+  size_t size(void) const;
+
+  std::vector<int16_t> CivID;
+  std::vector<int16_t> UnitID;
+
+  std::vector<uint8_t> Type;
+  std::vector<int16_t> Class;
+  std::vector<int16_t> HitPoints;
+  std::vector<float> LineOfSight;
+  std::vector<float> Speed;
+
+  /// Type 50
+  std::vector<int16_t> BaseArmor;
+  std::vector<float> MaxRange;
+  std::vector<float> ReloadTime;
+  std::vector<int16_t> DisplayedAttack;
+
+  /// Type 70
+  std::vector<int16_t> TrainTime;
+
+  /// Creatable.ResourceCosts
+  std::vector<uint32_t> CostBegin;
+  std::vector<int16_t> CostType;
+  std::vector<int16_t> CostAmount;
+  std::vector<int16_t> CostFlag;
+
+  /// Type50.Attacks
+  std::vector<uint32_t> AttackBegin;
+  std::vector<int16_t> AttackClass;
+  std::vector<int16_t> AttackAmount;
+
+  /// Type50.Armours
+  std::vector<uint32_t> ArmourBegin;
+  std::vector<int16_t> ArmourClass;
+  std::vector<int16_t> ArmourAmount;
+
+private:
+  void clear(void);
+};
+
+}
+
+#endif // GENIE_UNITCOLUMNS_H
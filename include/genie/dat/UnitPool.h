@@ -0,0 +1,66 @@
+/*
+    geniedat - A library for reading and writing data files of genie
+               engine games.
+    Copyright (C) 2011 - 2013  Armin Preiml
+    Copyright (C) 2011 - 2021  Mikko "Tapsa" P
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GENIE_UNITPOOL_H
+#define GENIE_UNITPOOL_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "Unit.h"
+
+namespace genie
+{
+
+//------------------------------------------------------------------------------
+/// Hands out one shared object for all units with the same content. Used
+/// while loading a dat file with DatFile::setShareUnits.
+//
+class UnitPool
+{
+public:
+  UnitPool();
+  virtual ~UnitPool();
+
+  //----------------------------------------------------------------------------
+  /// Returns the pooled unit equal to the given one. If there is none yet the
+  /// unit is moved into the pool.
+  ///
+  /// @param unit unit with its game version set
+  //
+  std::shared_ptr<Unit> share(Unit &unit);
+
+  //----------------------------------------------------------------------------
+  /// Number of distinct units and of units passed to share().
+  //
+  size_t getUniqueCount(void) const;
+  size_t getSharedCount(void) const;
+
+private:
+  /// Units by their serialized data.
+  std::unordered_map<std::string, std::shared_ptr<Unit>> units_;
+
+  size_t shared_ = 0;
+};
+
+}
+
+#endif // GENIE_UNITPOOL_H
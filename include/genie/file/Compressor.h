@@ -23,6 +23,7 @@
 
 #include <iostream>
 #include <memory>
+#include <vector>
 #include "ISerializable.h"
 
 namespace boost {
@@ -62,15 +63,34 @@ public:
   //----------------------------------------------------------------------------
   static void decompress(std::istream &source, std::ostream &sink);
 
+  //----------------------------------------------------------------------------
+  /// Lets data pass uncompressed, begin and endCompression do nothing then.
+  /// Used for snapshots that hold the inflated data of a file.
+  //
+  inline void setPassThrough(bool passThrough) { passThrough_ = passThrough; }
+  inline bool getPassThrough(void) const { return passThrough_; }
+
 private:
 
   ISerializable *obj_;
 
+  bool passThrough_ = false;
+
   std::istream *istream_ = 0;
   std::shared_ptr<std::istream> uncompressedIstream_;
 
-  std::ostream *ostream_;
-  std::shared_ptr<std::iostream> bufferedStream_;
+  std::ostream *ostream_ = 0;
+  std::shared_ptr<std::ostream> uncompressedOstream_;
+
+  /// Inflating or deflating stream buffer, works on fixed size chunks.
+  std::shared_ptr<std::streambuf> zlibBuffer_;
+
+  ReadBuffer *buffer_ = 0;
+  std::vector<char> inflated_;
+  std::shared_ptr<ReadBuffer> inflatedBuffer_;
+
+  WriteBuffer *writeBuffer_ = 0;
+  std::shared_ptr<WriteBuffer> uncompressedBuffer_;
 
   Compressor();
 
@@ -82,21 +102,36 @@ private:
   boost::iostreams::zlib_params getZlibParams(void) const;
 
   //----------------------------------------------------------------------------
-  /// Decompresses istream and sets uncompressedIstream_.
+  /// Sets uncompressedIstream_ to a stream inflating istream_ on demand.
   //
   void startDecompression(void);
 
+  //----------------------------------------------------------------------------
+  /// Inflates the rest of buffer_ into one contiguous block and sets
+  /// inflatedBuffer_.
+  //
+  void inflateBuffer(void);
+
   //----------------------------------------------------------------------------
   /// Closes decompressed stream.
   //
   void stopDecompression(void);
 
   //----------------------------------------------------------------------------
+  /// Redirects objects output to a stream deflating into ostream_.
+  //
   void startCompression(void);
 
   //----------------------------------------------------------------------------
+  /// Flushes the rest of the deflate stream and restores objects ostream.
+  //
   void stopCompression(void);
 
+  //----------------------------------------------------------------------------
+  /// Deflates uncompressedBuffer_ in one go, appending to writeBuffer_.
+  //
+  void deflateBuffer(void);
+
 };
 
 }
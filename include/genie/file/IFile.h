@@ -76,6 +76,18 @@ public:
   //
   virtual void load(const char *fileName);
 
+  //----------------------------------------------------------------------------
+  /// Loads the object from a memory mapped file. Data is parsed straight
+  /// from the mapping (and for compressed files from one inflated buffer)
+  /// instead of going through an input stream. Results in the same object
+  /// as load(const char *). Only usable for files that are parsed purely
+  /// through the serialize methods, like DatFile and ScnFile.
+  ///
+  /// @param fileName file name
+  /// @exception std::ios_base::failure thrown if file can't be mapped
+  //
+  void loadMapped(const char *fileName);
+
   //----------------------------------------------------------------------------
   /// Saves data to file. Can only be called if fileName is set through set
   /// method or the file was loaded using the load method.
@@ -94,6 +106,19 @@ public:
   //
   virtual void saveAs(const char *fileName);
 
+  //----------------------------------------------------------------------------
+  /// Saves data to a file through one memory buffer, sized up front by
+  /// objectSize(), and writes it out with a single write. Compressed parts
+  /// are deflated in one go. Results in the same file as
+  /// saveAs(const char *). Only usable for files that are written purely
+  /// through the serialize methods, like DatFile and ScnFile.
+  ///
+  /// @param fileName file name
+  /// @exception std::ios_base::failure thrown if file can't be written (
+  ///                                   insufficient rights...)
+  //
+  void saveBuffered(const char *fileName);
+
 protected:
 
   //----------------------------------------------------------------------------
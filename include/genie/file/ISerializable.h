@@ -24,14 +24,108 @@
 #include <iostream>
 
 #include "genie/Types.h"
+#include <algorithm>
 #include <array>
+#include <string>
+#include <type_traits>
 #include <vector>
 #include <string.h>
 #include <stdint.h>
 
+// Genie files are little endian, values are swapped on big endian hosts.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define GENIE_BIG_ENDIAN
+#endif
+
 namespace genie
 {
 
+//------------------------------------------------------------------------------
+/// Memory region read through a plain cursor. Used in place of an istream when
+/// the whole data is already available in memory.
+//
+struct ReadBuffer
+{
+  ReadBuffer(const char *begin, const char *end) :
+    begin(begin), pos(begin), end(end) {}
+
+  const char *begin;
+  const char *pos;
+  const char *end;
+};
+
+//------------------------------------------------------------------------------
+/// Growable memory region written through a plain cursor. Used in place of an
+/// ostream to serialize a whole object before it is written out at once.
+//
+struct WriteBuffer
+{
+  /// @param capacity bytes to allocate up front
+  WriteBuffer(size_t capacity = 0) :
+    data(std::max<size_t>(capacity, 1)), pos(data.data()),
+    end(data.data() + data.size()) {}
+
+  WriteBuffer(const WriteBuffer &) = delete;
+  WriteBuffer &operator=(const WriteBuffer &) = delete;
+
+  std::vector<char> data;
+  char *pos;
+  char *end;
+
+  /// Makes room for at least len more bytes at pos.
+  inline void reserve(size_t len)
+  {
+    if (static_cast<size_t>(end - pos) < len)
+      grow(len);
+  }
+
+  inline void write(const char *src, size_t len)
+  {
+    reserve(len);
+    memcpy(pos, src, len);
+    pos += len;
+  }
+
+  /// @return bytes written so far
+  inline size_t size(void) const
+  {
+    return pos - data.data();
+  }
+
+  void grow(size_t len);
+};
+
+class UnitPool;
+
+//------------------------------------------------------------------------------
+/// State shared by an object and its subobjects during one read, write or
+/// size calculation. Every top level call gets a fresh context, so different
+/// objects can be serialized on different threads at the same time.
+//
+struct SerializationContext
+{
+  /// "1.00" to "1.21"
+  std::string scn_ver = "0.00";
+
+  /// 1.0 to 1.30
+  float scn_plr_data_ver = 0.f, scn_internal_ver = 0.f;
+
+  /// 1.0 to 1.6
+  double scn_trigger_ver = 0.0;
+
+  /// Whether the CombinedResources being serialized contain player info.
+  bool scn_player_info = false;
+
+  /// Whether ScnMainPlayerData stops reading after the player names.
+  bool scn_player_names_only = false;
+
+  /// Terrain count of terrain restrictions, -1 if not set by a DatFile.
+  int terrain_count = -1;
+
+  /// Pool civs read their units into, set by a DatFile sharing units.
+  UnitPool *unit_pool = 0;
+};
+
 //------------------------------------------------------------------------------
 /// Generic base class for genie file serialization
 //
@@ -40,23 +134,29 @@ class ISerializable
 
 public:
   //----------------------------------------------------------------------------
-  ISerializable() : operation_(Operation::OP_CALC_SIZE), size_(0) {}
+  ISerializable() {}
 
   //----------------------------------------------------------------------------
-  virtual ~ISerializable() {}
+  /// Copies the game version, and the state if the object keeps its own.
+  //
+  ISerializable(const ISerializable &other);
+  ISerializable &operator=(const ISerializable &other);
+
+  //----------------------------------------------------------------------------
+  virtual ~ISerializable();
 
   //----------------------------------------------------------------------------
   /// Set position to start reading the object from stream
   //
   inline void setInitialReadPosition(std::streampos pos)
   {
-    init_read_pos_ = pos;
+    ownState().init_read_pos = pos;
   }
 
   //----------------------------------------------------------------------------
   inline std::streampos getInitialReadPosition(void) const
   {
-    return init_read_pos_;
+    return state_ ? state_->init_read_pos : std::streampos(0);
   }
 
   //----------------------------------------------------------------------------
@@ -66,6 +166,14 @@ public:
   //
   void readObject(std::istream &istr);
 
+  //----------------------------------------------------------------------------
+  /// Read object from a memory buffer. The initial read position is relative
+  /// to the beginning of the buffer.
+  ///
+  /// @param buffer Buffer to read from
+  //
+  void readObject(ReadBuffer &buffer);
+
   //----------------------------------------------------------------------------
   /// Write object to stream.
   ///
@@ -73,13 +181,21 @@ public:
   //
   void writeObject(std::ostream &ostr);
 
+  //----------------------------------------------------------------------------
+  /// Write object to a memory buffer, appending at its cursor.
+  ///
+  /// @param buffer Buffer to write to
+  //
+  void writeObject(WriteBuffer &buffer);
+
   //----------------------------------------------------------------------------
   /// Returns size in bytes.
   //
   virtual size_t objectSize(void);
 
   //----------------------------------------------------------------------------
-  /// Serialize this object as a subobject of another one.
+  /// Serialize this object as a subobject of another one. While calculating
+  /// sizes the size of this object is added to the root's.
   ///
   /// @param root The object to serialize from.
   //
@@ -116,21 +232,6 @@ public:
   //
   friend class Compressor;
 
-  //----------------------------------------------------------------------------
-  /// Versions used to read/write/paste.
-
-  /// 6 to 12
-  static float dat_internal_ver;
-
-  /// "1.00" to "1.21"
-  static std::string scn_ver;
-
-  /// 1.0 to 1.30
-  static float scn_plr_data_ver, scn_internal_ver;
-
-  /// 1.0 to 1.6
-  static double scn_trigger_ver;
-
 protected:
 
   enum Operation
@@ -148,6 +249,29 @@ protected:
     updateGameVersion<T>(getGameVersion(), vec);
   }
 
+  //----------------------------------------------------------------------------
+  /// Calls object.serializeVersioned(gv) with the game version wrapped in the
+  /// GameVersionRange of its family, see Types.h. The object's serializer is
+  /// compiled once per family and picked here, before any field is read or
+  /// written. The object has to befriend ISerializable.
+  //
+  template <typename T>
+  void serializeByFamily(T &object)
+  {
+    GameVersion gv = getGameVersion();
+
+    if (gv <= GV_RoR)
+      object.serializeVersioned(AoEVersions(gv));
+    else if (gv <= GV_LatestTap)
+      object.serializeVersioned(TapsaVersions(gv));
+    else if (gv <= GV_Cysion)
+      object.serializeVersioned(AoKVersions(gv));
+    else if (gv <= GV_LatestDE2)
+      object.serializeVersioned(DE2Versions(gv));
+    else
+      object.serializeVersioned(SWGBVersions(gv));
+  }
+
   //----------------------------------------------------------------------------
   /// Set operation to process
   ///
@@ -155,7 +279,7 @@ protected:
   //
   inline void setOperation(Operation op)
   {
-    operation_ = op;
+    ownState().operation = op;
   }
 
   //----------------------------------------------------------------------------
@@ -165,7 +289,7 @@ protected:
   //
   inline Operation getOperation(void) const
   {
-    return operation_;
+    return state_ ? state_->operation : OP_CALC_SIZE;
   }
 
   //----------------------------------------------------------------------------
@@ -175,31 +299,76 @@ protected:
   //
   inline bool isOperation(Operation op) const
   {
-    return (op == operation_);
+    return (op == getOperation());
   }
 
   //----------------------------------------------------------------------------
   inline void setIStream(std::istream &istr)
   {
-    istr_ = &istr;
+    ownState().istr = &istr;
   }
 
   //----------------------------------------------------------------------------
   inline std::istream * getIStream(void)
   {
-    return istr_;
+    return state_ ? state_->istr : 0;
+  }
+
+  //----------------------------------------------------------------------------
+  /// Set memory buffer to read from. Takes precedence over the istream.
+  //
+  inline void setReadBuffer(ReadBuffer *buffer)
+  {
+    ownState().ibuf = buffer;
+  }
+
+  //----------------------------------------------------------------------------
+  inline ReadBuffer * getReadBuffer(void)
+  {
+    return state_ ? state_->ibuf : 0;
   }
 
   //----------------------------------------------------------------------------
   inline void setOStream(std::ostream &ostr)
   {
-    ostr_ = &ostr;
+    ownState().ostr = &ostr;
   }
 
   //----------------------------------------------------------------------------
   inline std::ostream * getOStream(void)
   {
-    return ostr_;
+    return state_ ? state_->ostr : 0;
+  }
+
+  //----------------------------------------------------------------------------
+  /// Set memory buffer to write to. Takes precedence over the ostream.
+  //
+  inline void setWriteBuffer(WriteBuffer *buffer)
+  {
+    ownState().obuf = buffer;
+  }
+
+  //----------------------------------------------------------------------------
+  inline WriteBuffer * getWriteBuffer(void)
+  {
+    return state_ ? state_->obuf : 0;
+  }
+
+  //----------------------------------------------------------------------------
+  /// Makes the object keep the streams and positions set on it between
+  /// calls, for objects that read parts of their data on demand.
+  //
+  inline void keepState(void)
+  {
+    ownState();
+  }
+
+  //----------------------------------------------------------------------------
+  /// @return context of the current read, write or size calculation.
+  //
+  inline SerializationContext & getContext(void)
+  {
+    return *state_->context;
   }
 
   //----------------------------------------------------------------------------
@@ -246,10 +415,24 @@ protected:
   template <typename T>
   T read()
   {
-    if (!istr_->eof())
+    if (state_->ibuf)
     {
       T ret;
-      istr_->read(reinterpret_cast<char *>(&ret), sizeof(ret));
+      if (static_cast<size_t>(state_->ibuf->end - state_->ibuf->pos) >= sizeof(T))
+      {
+        memcpy(&ret, state_->ibuf->pos, sizeof(T));
+        state_->ibuf->pos += sizeof(T);
+        swapFileOrder(&ret, 1);
+        return ret;
+      }
+      state_->ibuf->pos = state_->ibuf->end;
+      return T();
+    }
+    if (!state_->istr->eof())
+    {
+      T ret;
+      state_->istr->read(reinterpret_cast<char *>(&ret), sizeof(ret));
+      swapFileOrder(&ret, 1);
       return ret;
     }
     return T();
@@ -263,7 +446,13 @@ protected:
   template <typename T>
   void write(T &data)
   {
-    ostr_->write(reinterpret_cast<char *>(&data), sizeof(T));
+#ifdef GENIE_BIG_ENDIAN
+    T swapped = data;
+    swapFileOrder(&swapped, 1);
+    writeBytes(reinterpret_cast<char *>(&swapped), sizeof(T));
+#else
+    writeBytes(reinterpret_cast<char *>(&data), sizeof(T));
+#endif
   }
 
   //----------------------------------------------------------------------------
@@ -272,12 +461,28 @@ protected:
   template <typename T>
   void read(T **array, size_t len)
   {
-    if (!istr_->eof())
+    if (state_->ibuf)
+    {
+      if (state_->ibuf->pos != state_->ibuf->end)
+      {
+        if (*array == 0)
+          *array = new T[len];
+
+        size_t bytes = std::min(sizeof(T) * len,
+          static_cast<size_t>(state_->ibuf->end - state_->ibuf->pos));
+        memcpy(*array, state_->ibuf->pos, bytes);
+        state_->ibuf->pos += bytes;
+        swapFileOrder(*array, bytes / sizeof(T));
+      }
+      return;
+    }
+    if (!state_->istr->eof())
     {
       if (*array == 0)
         *array = new T[len];
 
-      istr_->read(reinterpret_cast<char *>(*array), sizeof(T) * len);
+      state_->istr->read(reinterpret_cast<char *>(*array), sizeof(T) * len);
+      swapFileOrder(*array, static_cast<size_t>(state_->istr->gcount()) / sizeof(T));
     }
   }
 
@@ -287,7 +492,7 @@ protected:
   template <typename T>
   void write(T **data, size_t len)
   {
-    ostr_->write(reinterpret_cast<char *>(*data), sizeof(T) * len);
+    writeArray(*data, len);
   }
 
   //----------------------------------------------------------------------------
@@ -362,7 +567,51 @@ protected:
         data = read<T>();
         break;
       case OP_CALC_SIZE:
-        size_ += sizeof(T);
+        state_->size += sizeof(T);
+        break;
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  /// Serializes a run of basic data type fields, in the given order. Same as
+  /// calling serialize<T> on each field, but the layout of the run is known
+  /// at compile time: its size is a constant and buffers are bounds checked
+  /// and advanced once for the whole run, with every field at a fixed offset.
+  /// Streams and runs cut short by the end of data take the per field path.
+  //
+  template <typename... T>
+  void serializeFields(T &... fields)
+  {
+    const size_t bytes = fieldsSize<T...>();
+
+    switch(getOperation())
+    {
+      case OP_WRITE:
+        if (state_->obuf)
+        {
+          state_->obuf->reserve(bytes);
+          writeFields(state_->obuf->pos, fields...);
+          state_->obuf->pos += bytes;
+        }
+        else
+        {
+          serializeEach(fields...);
+        }
+        break;
+      case OP_READ:
+        if (state_->ibuf &&
+          static_cast<size_t>(state_->ibuf->end - state_->ibuf->pos) >= bytes)
+        {
+          readFields(state_->ibuf->pos, fields...);
+          state_->ibuf->pos += bytes;
+        }
+        else
+        {
+          serializeEach(fields...);
+        }
+        break;
+      case OP_CALC_SIZE:
+        state_->size += bytes;
         break;
     }
   }
@@ -371,9 +620,6 @@ protected:
   void serialize(ISerializable &data)
   {
     data.serializeSubObject(this);
-
-    if (isOperation(OP_CALC_SIZE))
-      size_ += data.objectSize();
   }
 
   //----------------------------------------------------------------------------
@@ -391,7 +637,7 @@ protected:
         read<T>(data, len);
         break;
       case OP_CALC_SIZE:
-        size_ += sizeof(T) * len;
+        state_->size += sizeof(T) * len;
         break;
     }
   }
@@ -412,7 +658,7 @@ protected:
           str = readString(len);
           break;
         case Operation::OP_CALC_SIZE:
-          size_ += sizeof(char) * len;
+          state_->size += sizeof(char) * len;
           break;
       }
     }
@@ -430,21 +676,19 @@ protected:
         if (vec.size() != size)
           std::cerr << "Warning!: vector size differs len!" << vec.size() << " " << size <<  std::endl;
 
-        for (auto it = vec.begin(); it != vec.end(); ++it)
-          write<T>(*it);
+        writeElements(vec, IsBlock<T>());
 
         break;
 
       case OP_READ:
         vec.resize(size);
 
-        for (size_t i=0; i < size; ++i)
-          vec[i] = read<T>();
+        readElements(vec, IsBlock<T>());
 
         break;
 
       case OP_CALC_SIZE:
-        size_ += size * sizeof(T);
+        state_->size += size * sizeof(T);
         break;
     }
   }
@@ -462,8 +706,7 @@ protected:
           std::cerr << "Warning!: vector size differs len!" << vec.size() << " " << size <<  std::endl;
 
         for (size_t i=0; i < size; ++i)
-          for (auto it = vec[i].begin(); it != vec[i].end(); ++it)
-            write<T>(*it);
+          writeElements(vec[i], IsBlock<T>());
 
         break;
 
@@ -473,14 +716,13 @@ protected:
         for (size_t i=0; i < size; ++i)
         {
           vec[i].resize(size2);
-          for (size_t j=0; j < size2; ++j)
-            vec[i][j] = read<T>();
+          readElements(vec[i], IsBlock<T>());
         }
 
         break;
 
       case OP_CALC_SIZE:
-        size_ += size * size2 * sizeof(T);
+        state_->size += size * size2 * sizeof(T);
         break;
     }
   }
@@ -501,9 +743,6 @@ protected:
         ISerializable *data = static_cast<ISerializable *>(&(*it));
 
         data->serializeSubObject(this);
-
-        if (isOperation(OP_CALC_SIZE))
-          size_ += data->objectSize();
       }
     }
     else
@@ -520,12 +759,12 @@ protected:
 
   //----------------------------------------------------------------------------
   /// Serialize a vector size number. If size differs, the number will be
-  /// updated.
+  /// updated. Size calculation uses the same number as writing.
   //
   template <typename T>
   void serializeSize(T &data, size_t size)
   {
-    if (isOperation(OP_WRITE))
+    if (isOperation(OP_WRITE) || isOperation(OP_CALC_SIZE))
       data = static_cast<T>(size);
 
     serialize<T>(data);
@@ -542,7 +781,7 @@ protected:
   void serializeSize(T &data, std::string str, bool cString=true)
   {
     // calculate new size
-    if (isOperation(OP_WRITE))
+    if (isOperation(OP_WRITE) || isOperation(OP_CALC_SIZE))
     {
       size_t size = str.size();
 
@@ -572,9 +811,6 @@ protected:
         {
           ISerializable *data = static_cast<ISerializable *>(&vec[i]);
           data->serializeSubObject(this);
-
-          if (isOperation(OP_CALC_SIZE))
-            size_ += data->objectSize();
         }
       }
     }
@@ -618,25 +854,213 @@ protected:
         break;
 
       case OP_CALC_SIZE:
-        size_ += sizeof(T);
+        state_->size += sizeof(T);
 
         if (!only_first)
-          size_ += sizeof(T);
+          state_->size += sizeof(T);
         break;
     }
   }
 
 private:
-  std::istream *istr_ = 0;
-  std::ostream *ostr_ = 0;
+  //----------------------------------------------------------------------------
+  /// Element types whose vectors are read and written as one block of memory.
+  //
+  template <typename T>
+  struct IsBlock : std::integral_constant<bool,
+    std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>
+  {
+  };
+
+  //----------------------------------------------------------------------------
+  /// Swaps arithmetic values between file and host byte order. Does nothing
+  /// on little endian hosts.
+  //
+  template <typename T>
+  static void swapFileOrder(T *data, size_t count)
+  {
+#ifdef GENIE_BIG_ENDIAN
+    if (!std::is_arithmetic<T>::value)
+      return;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      char *bytes = reinterpret_cast<char *>(data + i);
+      std::reverse(bytes, bytes + sizeof(T));
+    }
+#else
+    (void)data;
+    (void)count;
+#endif
+  }
+
+  //----------------------------------------------------------------------------
+  /// Bytes taken by a run of fields, see serializeFields.
+  //
+  template <typename T>
+  static constexpr size_t fieldsSize(void)
+  {
+    static_assert(IsBlock<T>::value, "Fields must be basic data types");
+    return sizeof(T);
+  }
+
+  template <typename T, typename U, typename... Rest>
+  static constexpr size_t fieldsSize(void)
+  {
+    return fieldsSize<T>() + fieldsSize<U, Rest...>();
+  }
+
+  //----------------------------------------------------------------------------
+  static void readFields(const char *)
+  {
+  }
+
+  template <typename T, typename... Rest>
+  static void readFields(const char *src, T &field, Rest &... rest)
+  {
+    memcpy(&field, src, sizeof(T));
+    swapFileOrder(&field, 1);
+    readFields(src + sizeof(T), rest...);
+  }
+
+  //----------------------------------------------------------------------------
+  static void writeFields(char *)
+  {
+  }
+
+  template <typename T, typename... Rest>
+  static void writeFields(char *dst, const T &field, const Rest &... rest)
+  {
+    T value = field;
+    swapFileOrder(&value, 1);
+    memcpy(dst, &value, sizeof(T));
+    writeFields(dst + sizeof(T), rest...);
+  }
 
-  std::streampos init_read_pos_ = 0;
+  //----------------------------------------------------------------------------
+  void serializeEach(void)
+  {
+  }
+
+  template <typename T, typename... Rest>
+  void serializeEach(T &field, Rest &... rest)
+  {
+    serialize<T>(field);
+    serializeEach(rest...);
+  }
+
+  //----------------------------------------------------------------------------
+  /// Writes count values in file byte order.
+  //
+  template <typename T>
+  void writeArray(const T *data, size_t count)
+  {
+#ifdef GENIE_BIG_ENDIAN
+    std::vector<T> swapped(data, data + count);
+    swapFileOrder(swapped.data(), count);
+    data = swapped.data();
+#endif
+    writeBytes(reinterpret_cast<const char *>(data), sizeof(T) * count);
+  }
+
+  //----------------------------------------------------------------------------
+  inline void writeBytes(const char *data, size_t len)
+  {
+    if (state_->obuf)
+      state_->obuf->write(data, len);
+    else
+      state_->ostr->write(data, len);
+  }
+
+  //----------------------------------------------------------------------------
+  /// Reads all elements of a sized vector. Elements missing at the end of the
+  /// data are value initialized, like read() does for single values.
+  //
+  template <typename T>
+  void readElements(std::vector<T> &vec, std::true_type)
+  {
+    size_t bytes = sizeof(T) * vec.size();
+    size_t got = 0;
+
+    if (bytes == 0)
+      return;
+
+    if (state_->ibuf)
+    {
+      got = std::min(bytes, static_cast<size_t>(state_->ibuf->end - state_->ibuf->pos));
+      memcpy(vec.data(), state_->ibuf->pos, got);
+      state_->ibuf->pos += got;
+    }
+    else if (!state_->istr->eof())
+    {
+      state_->istr->read(reinterpret_cast<char *>(vec.data()), bytes);
+      got = static_cast<size_t>(state_->istr->gcount());
+    }
+
+    size_t count = got / sizeof(T);
+    std::fill(vec.begin() + count, vec.end(), T());
+    swapFileOrder(vec.data(), count);
+  }
+
+  template <typename T>
+  void readElements(std::vector<T> &vec, std::false_type)
+  {
+    for (size_t i = 0; i < vec.size(); ++i)
+      vec[i] = read<T>();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void writeElements(std::vector<T> &vec, std::true_type)
+  {
+    writeArray(vec.data(), vec.size());
+  }
+
+  template <typename T>
+  void writeElements(std::vector<T> &vec, std::false_type)
+  {
+    for (auto it = vec.begin(); it != vec.end(); ++it)
+      write<T>(*it);
+  }
+
+  //----------------------------------------------------------------------------
+  /// Stream and operation state of a read, write or size calculation.
+  //
+  struct State
+  {
+    std::istream *istr = 0;
+    std::ostream *ostr = 0;
+    WriteBuffer *obuf = 0;
+    ReadBuffer *ibuf = 0;
+    SerializationContext *context = 0;
+
+    std::streampos init_read_pos = 0;
+
+    Operation operation = OP_CALC_SIZE;
+
+    /// Bytes counted so far while calculating sizes.
+    size_t size = 0;
+  };
+
+  //----------------------------------------------------------------------------
+  /// Points state_ to the state of one serialization and back.
+  //
+  class StateScope;
+
+  //----------------------------------------------------------------------------
+  /// Makes the object keep a state of its own from now on.
+  //
+  State &ownState(void);
 
-  Operation operation_;
+  /// State of the current serialization, shared by an object and all its
+  /// subobjects, so small records don't have to carry it. Objects whose
+  /// state was set from outside, like files read on demand, keep their own.
+  /// Null while not serialized.
+  State *state_ = 0;
 
   GameVersion gameVersion_ = GameVersion::GV_None;
 
-  size_t size_;
+  bool own_state_ = false;
 };
 
 //----------------------------------------------------------------------------
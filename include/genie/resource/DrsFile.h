@@ -22,20 +22,52 @@
 
 #include <vector>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <stdint.h>
 
 #include "genie/file/IFile.h"
 #include "SlpFile.h"
-#include "BinaFile.h"
+#include "PalFile.h"
 
 namespace genie
 {
 
 class Logger;
+class SpriteCache;
 
 //------------------------------------------------------------------------------
-/// Base class for .drs files
+/// Read only view of a resource inside a drs file. Valid as long as the
+/// DrsFile it came from.
+//
+struct DrsSpan
+{
+  const uint8_t *data = nullptr;
+  size_t size = 0;
+
+  inline const uint8_t *begin(void) const { return data; }
+  inline const uint8_t *end(void) const { return data + size; }
+  inline bool empty(void) const { return size == 0; }
+};
+
+//------------------------------------------------------------------------------
+/// Location of a resource in a drs file.
+//
+struct DrsEntry
+{
+  uint32_t id;
+  uint32_t offset;
+  uint32_t length;
+};
+
+//------------------------------------------------------------------------------
+/// Base class for .drs files. The file is memory mapped while loaded,
+/// resources are located through an index sorted by id.
+///
+/// Once loaded, any number of threads may get resources at the same time.
+/// Each slp file is parsed from its own stream over the mapping, palettes
+/// are parsed into a new object per call and raw data is never modified.
 //
 class DrsFile : public IFile
 {
@@ -51,6 +83,16 @@ public:
   //
   virtual ~DrsFile();
 
+  using IFile::load;
+
+  //----------------------------------------------------------------------------
+  /// Maps the file and loads its table and resource headers.
+  ///
+  /// @param fileName file name
+  /// @exception std::ios_base::failure thrown if file can't be read
+  //
+  virtual void load(const char *fileName) override;
+
   //----------------------------------------------------------------------------
   /// Get a shared pointer to a slp file.
   ///
@@ -60,19 +102,66 @@ public:
   SlpFilePtr getSlpFile(uint32_t id);
 
   //----------------------------------------------------------------------------
-  /// Get a shared pointer to a color palette file.
+  /// Get a shared pointer to a color palette file. Each palette is parsed on
+  /// its first request, later requests return the same object.
   ///
   /// @param id resource id
   /// @return bina file pointer or "empty" shared pointer if not found
   //
   PalFilePtr getPalFile(uint32_t id);
 
-  unsigned char* getWavPtr(uint32_t id);
+  //----------------------------------------------------------------------------
+  /// Slp files returned by getSlpFile() will decode their frames on demand.
+  /// See SlpFile::setLazyLoading.
+  //
+  inline void setLazySlpLoading(bool lazy) { lazy_slps_ = lazy; }
+
+  //----------------------------------------------------------------------------
+  /// Threads used by slp files returned by getSlpFile() to decode frames.
+  /// See SlpFile::setDecodeThreadCount.
+  //
+  inline void setSlpDecodeThreadCount(unsigned int count)
+  {
+    slp_decode_threads_ = count;
+  }
+
+  //----------------------------------------------------------------------------
+  /// Slp files returned by getSlpFile() report their decoded frames to the
+  /// cache, which evicts them when over its budget. Implies lazy loading.
+  /// One cache, like SpriteCache::getGlobalCache(), may be shared by several
+  /// archives. It has to outlive the archive. See SlpFile::setSpriteCache.
+  ///
+  /// @param cache cache to use, nullptr to keep all decoded frames
+  //
+  inline void setSpriteCache(SpriteCache *cache) { sprite_cache_ = cache; }
+
+  //----------------------------------------------------------------------------
+  /// Get a pointer to a wav file, including its RIFF header.
+  ///
+  /// @param id resource id
+  /// @return pointer into the drs data or NULL if not found
+  //
+  const unsigned char* getWavPtr(uint32_t id);
+
+  //----------------------------------------------------------------------------
+  /// Get the raw data of a resource without copying it.
+  ///
+  /// @param id resource id
+  /// @return span of the resource, empty if not found
+  //
+  DrsSpan getSlpData(uint32_t id) const;
+  DrsSpan getBinaryData(uint32_t id) const;
+  DrsSpan getWavData(uint32_t id) const;
 
 private:
   static Logger &log;
 
+  struct Mapping;
+
   bool header_loaded_ = false;
+  bool lazy_slps_ = false;
+  unsigned int slp_decode_threads_ = 1;
+  SpriteCache *sprite_cache_ = nullptr;
 
   uint32_t num_of_tables_;
   uint32_t header_offset_;
@@ -80,11 +169,33 @@ private:
   std::vector<std::string> table_types_;
   std::vector<uint32_t> table_num_of_files_;
 
-  std::vector<uint8_t> wav_file_;
+  std::unique_ptr<Mapping> mapping_;
+  std::vector<uint8_t> file_data_;
+  const uint8_t *data_ = nullptr;
+  size_t data_size_ = 0;
 
-  std::unordered_map<uint32_t, SlpFilePtr> slp_map_;
-  std::unordered_map<uint32_t, BinaFilePtr> bina_map_;
-  std::unordered_map<uint32_t, uint32_t> wav_offsets_;
+  std::vector<DrsEntry> slp_index_;
+  std::vector<DrsEntry> bina_index_;
+  std::vector<DrsEntry> wav_index_;
+
+  //----------------------------------------------------------------------------
+  /// Slp file handed out for an id. Loaded under its own lock, from a stream
+  /// that lives as long as the file may reload from it.
+  //
+  struct SlpSlot
+  {
+    std::mutex mutex;
+    SlpFilePtr slp;
+    std::unique_ptr<IMemoryStream> stream;
+  };
+
+  std::mutex slp_map_mutex_;
+  std::unordered_map<uint32_t, SlpSlot> slp_map_;
+
+  /// Palettes handed out by id. They are small, so they are parsed under the
+  /// map lock.
+  std::mutex pal_map_mutex_;
+  std::unordered_map<uint32_t, PalFilePtr> pal_map_;
 
   unsigned int getCopyRightHeaderSize(void) const;
 
@@ -97,6 +208,19 @@ private:
   //
   void loadHeader();
 
+  //----------------------------------------------------------------------------
+  /// Finds a resource in a sorted index.
+  ///
+  /// @return entry or null if not found
+  //
+  static const DrsEntry *findEntry(const std::vector<DrsEntry> &index,
+                                   uint32_t id);
+
+  //----------------------------------------------------------------------------
+  /// Span of a resource, clipped to the data.
+  //
+  DrsSpan getData(const std::vector<DrsEntry> &index, uint32_t id) const;
+
   virtual void serializeObject(void);
 };
 
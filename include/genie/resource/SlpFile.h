@@ -21,6 +21,7 @@
 #define GENIE_SLPFILE_H
 
 #include <istream>
+#include <mutex>
 #include <vector>
 
 #include "genie/file/IFile.h"
@@ -32,6 +33,8 @@
 namespace genie
 {
 
+class SpriteCache;
+
 //------------------------------------------------------------------------------
 /// A slp file stores one or several images encoded using simple commands.
 /// The image is stored as 8 bits per pixel, that means only the index of a
@@ -68,6 +71,48 @@ public:
   //
   inline bool isLoaded(void) const { return loaded_; }
 
+  //----------------------------------------------------------------------------
+  /// In lazy mode loading only reads the headers and keeps the raw slp data
+  /// in memory. Each frame is decoded on its first getFrame() call, which
+  /// may come from several threads at once.
+  /// Has to be set before loading.
+  //
+  inline void setLazyLoading(bool lazy) { lazy_ = lazy; }
+  inline bool isLazyLoading(void) const { return lazy_; }
+
+  //----------------------------------------------------------------------------
+  /// Size of the slp data in the stream, used by lazy loading to copy the
+  /// data out of container files. 0 means till the end of the stream.
+  //
+  inline void setDataSize(uint32_t size) { data_size_ = size; }
+
+  //----------------------------------------------------------------------------
+  /// Number of threads decoding frames while loading. Frames are spread
+  /// over the threads of WorkerPool::getGlobalPool(), spare threads split
+  /// the rows of tall frames. Ignored in lazy mode.
+  ///
+  /// @param count 1 to decode serially (default), 0 for one per core
+  //
+  void setDecodeThreadCount(unsigned int count);
+
+  //----------------------------------------------------------------------------
+  /// Reports frames decoded in lazy mode to the cache, which may evict them
+  /// again to stay within its budget. Evicted frames are replaced by header
+  /// only frames and decoded again on their next getFrame() call. Frames
+  /// still held by callers stay valid.
+  ///
+  /// @param cache cache to use, nullptr to keep all decoded frames
+  //
+  void setSpriteCache(SpriteCache *cache);
+  inline SpriteCache *getSpriteCache(void) const { return cache_; }
+
+  //----------------------------------------------------------------------------
+  /// Drops a lazily decoded frame. Does nothing if the file is not lazy.
+  ///
+  /// @return bytes of memory freed
+  //
+  size_t evictFrame(uint16_t frame) override;
+
   //----------------------------------------------------------------------------
   /// Return number of frames stored in the file. Available after load.
   ///
@@ -77,7 +122,13 @@ public:
   void setFrameCount(uint16_t);
 
   //----------------------------------------------------------------------------
-  /// Returns the slp frame at given frame index.
+  /// Return approximate size in memory, including lazily decoded frames.
+  //
+  size_t getSizeInMemory(void) const override;
+
+  //----------------------------------------------------------------------------
+  /// Returns the slp frame at given frame index. In lazy mode the frame is
+  /// decoded here on first access.
   ///
   /// @param frame frame index
   /// @return SlpFrame
@@ -92,6 +143,8 @@ private:
   static Logger &log;
 
   bool loaded_ = false;
+  bool lazy_ = false;
+  unsigned int decode_threads_ = 1;
 
   uint16_t num_frames_ = 0;
   uint16_t properties_;
@@ -100,6 +153,15 @@ private:
   typedef std::vector<SlpFramePtr> FrameVector;
   FrameVector frames_;
 
+  /// Raw slp data kept for lazy decoding.
+  uint32_t data_size_ = 0;
+  std::vector<char> data_;
+  std::vector<bool> decoded_;
+  std::vector<size_t> frame_memory_;
+  mutable std::mutex decode_mutex_;
+
+  SpriteCache *cache_ = nullptr;
+
   //----------------------------------------------------------------------------
   virtual void serializeObject(void);
 
@@ -108,6 +170,49 @@ private:
   //
   void loadFile(void);
 
+  //----------------------------------------------------------------------------
+  /// Reads the rest of the slp header, after the version.
+  //
+  void readHeader(void);
+
+  //----------------------------------------------------------------------------
+  /// Creates the frames and reads their (shadow) headers.
+  //
+  void readFrameHeaders(void);
+
+  //----------------------------------------------------------------------------
+  /// Creates a frame from its (shadow) header in data_.
+  //
+  SlpFramePtr readFrameHeader(uint16_t frame) const;
+
+  //----------------------------------------------------------------------------
+  /// Copies the slp data into data_, decompressing 4.2P files, and reads
+  /// the headers from it.
+  //
+  void loadData(void);
+
+  //----------------------------------------------------------------------------
+  /// Decodes all frames from data_ on decode_threads_ threads.
+  //
+  void decodeFrames(void);
+
+  //----------------------------------------------------------------------------
+  /// Decodes a lazy frame from data_ and marks it decoded. The caller holds
+  /// decode_mutex_.
+  ///
+  /// @return memory used by the frame
+  //
+  size_t decodeFrame(uint16_t frame);
+
+  //----------------------------------------------------------------------------
+  /// Decodes a frame and its shadow from data_. Touches only the frame, so
+  /// different frames can be decoded at the same time.
+  ///
+  /// @param row_threads threads decoding rows of the frame
+  /// @return memory used by the frame
+  //
+  size_t decodeFrameData(uint16_t frame, unsigned int row_threads = 1);
+
   //----------------------------------------------------------------------------
   /// Saves the file and its frames.
   //
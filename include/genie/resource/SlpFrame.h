@@ -79,12 +79,6 @@ public:
   //
   virtual ~SlpFrame();
 
-  //----------------------------------------------------------------------------
-  /// Set slp file position inside the stream. It's necesarry for calculating
-  /// file offsets.
-  //
-  inline void setSlpFilePos(std::streampos pos) { slp_file_pos_ = pos; }
-
   //----------------------------------------------------------------------------
   /// Loads header data. The headers of frames are stored after the header of
   /// the slp file.
@@ -98,21 +92,33 @@ public:
   void serializeShadowHeader(void);
 
   //----------------------------------------------------------------------------
-  /// Set stream parameters for loading frame data.
+  /// Set stream parameters for loading frame headers.
   //
   void setLoadParams(std::istream &istr);
 
   //----------------------------------------------------------------------------
   /// Loads frame data and creates an image. Frame data is located after all
-  /// frame headers of the slp file.
+  /// frame headers of the slp file. Rows are decoded straight from the slp
+  /// data, tall frames may be split over several threads.
+  ///
+  /// @param slp_data whole slp file, header offsets are relative to it
+  /// @param slp_size size of slp_data
+  /// @param properties properties of the slp file
+  /// @param row_threads maximum number of threads decoding rows
+  /// @exception std::ios_base::failure thrown if tables or commands lie
+  ///            outside of slp_data
   //
-  size_t load(uint16_t properties);
+  size_t load(const uint8_t *slp_data, size_t slp_size, uint16_t properties,
+              unsigned int row_threads = 1);
 
   //----------------------------------------------------------------------------
   /// Loads shadow frame data and creates an image. Shadow frame data is
   /// located after all shadow frame headers of the slp file.
+  ///
+  /// @exception std::ios_base::failure thrown if tables or commands lie
+  ///            outside of slp_data
   //
-  size_t loadSpecialShadow(void);
+  size_t loadSpecialShadow(const uint8_t *slp_data, size_t slp_size);
 
   //----------------------------------------------------------------------------
   /// Builds frame data from an image.
@@ -169,7 +175,8 @@ public:
 private:
   static Logger &log;
 
-  std::streampos slp_file_pos_;
+  struct CommandReader;
+
   bool programmed_decay;
 
   uint32_t cmd_table_offset_;
@@ -203,41 +210,67 @@ private:
   virtual void serializeObject(void);
 
   //----------------------------------------------------------------------------
-  /// Reads pixel indexes from file and sets the pixels according to the
-  /// colors from the palette.
-  /// It is assumed that the stream pointer is at the start of the pixel array.
+  /// Decodes the commands of rows [first_row, end_row). Pixels are written to
+  /// img_data, mask entries to masks.
   ///
+  /// @return false if the commands contain unknown or obsolete commands
+  //
+  bool decodeRows(const uint8_t *slp_data, size_t slp_size,
+                  uint32_t first_row, uint32_t end_row,
+                  const std::vector<uint16_t> &edges,
+                  const std::vector<uint32_t> &cmd_offsets,
+                  SlpFrameData &masks);
+
+  //----------------------------------------------------------------------------
+  /// Number of the count pixels starting at col that lie inside the row.
+  /// Commands running past the right edge are clipped there.
+  //
+  uint32_t pixelsInRow(uint32_t col, uint32_t count) const;
+
+  //----------------------------------------------------------------------------
+  /// Reads pixel indexes from the commands and sets the pixels according to
+  /// the colors from the palette.
+  ///
+  /// @param cmds commands positioned at the start of the pixel array
   /// @param row row to set pixels at
   /// @param col column to set pixels from
   /// @param count how many pixels should be read
+  /// @param masks masks to add player color pixels to
   /// @param player_col if true, pixel will be written to player color image
   //
-  void readPixelsToImage(uint32_t row, uint32_t &col, uint32_t count,
+  void readPixelsToImage(CommandReader &cmds, uint32_t row, uint32_t &col,
+                         uint32_t count, SlpFrameData &masks,
                          bool player_col = false);
-  void readPixelsToImage32(uint32_t row, uint32_t &col, uint32_t count,
-                         uint8_t special = 0);
-  void readPixelsToSpecialShadow(uint32_t row, uint32_t &col, uint32_t count);
+  void readPixelsToImage32(CommandReader &cmds, uint32_t row, uint32_t &col,
+                           uint32_t count, SlpFrameData &masks,
+                           uint8_t special = 0);
+  void readPixelsToSpecialShadow(CommandReader &cmds, uint32_t row,
+                                 uint32_t &col, uint32_t count);
 
   //----------------------------------------------------------------------------
-  /// Sets the next count of pixels to given color without reading from stream.
+  /// Sets the next count of pixels to the color following the command.
   ///
+  /// @param cmds commands positioned at the color
   /// @param row row to set pixels at
   /// @param col column to set pixels from
   /// @param count how many pixels should be set
-  /// @param color color to set
+  /// @param masks masks to add player color pixels to
   /// @param player_col if true, pixel will be written to player color image
   //
-  void setPixelsToColor(uint32_t row, uint32_t &col, uint32_t count,
-                        bool player_col = false);
-  void setPixelsToColor32(uint32_t row, uint32_t &col, uint32_t count,
+  void setPixelsToColor(CommandReader &cmds, uint32_t row, uint32_t &col,
+                        uint32_t count, SlpFrameData &masks,
                         bool player_col = false);
-  void setPixelsToSpecialShadow(uint32_t row, uint32_t &col, uint32_t count);
+  void setPixelsToColor32(CommandReader &cmds, uint32_t row, uint32_t &col,
+                          uint32_t count, SlpFrameData &masks,
+                          bool player_col = false);
+  void setPixelsToSpecialShadow(CommandReader &cmds, uint32_t row,
+                                uint32_t &col, uint32_t count);
 
   //----------------------------------------------------------------------------
-  /// Sets the next count of pixels to shadow without reading from stream.
-  void setPixelsToShadow(uint32_t row, uint32_t &col, uint32_t count);
-  void setPixelsToShield(uint32_t row, uint32_t &col, uint32_t count);
-  void setPixelsToPcOutline(uint32_t row, uint32_t &col, uint32_t count);
+  /// Adds the next count of pixels to a shadow, shield or outline mask.
+  //
+  void setPixelsToMask(std::vector<XY16> &mask, uint32_t row, uint32_t &col,
+                       uint32_t count);
 
   //----------------------------------------------------------------------------
   /// This method returns either the count stored in command byte or (if not
@@ -245,7 +278,7 @@ private:
   ///
   /// @param data command byte
   //
-  uint8_t getPixelCountFromData(uint8_t data);
+  uint8_t getPixelCountFromData(CommandReader &cmds, uint8_t data);
 
   enum cnt_type {CNT_LEFT, CNT_SAME, CNT_DIFF, CNT_TRANSPARENT, CNT_FEATHERING, CNT_PLAYER, CNT_SHIELD, CNT_PC_OUTLINE, CNT_SHADOW};
   void handleColors(cnt_type count_type, uint32_t row, uint32_t col, uint32_t count, std::vector<uint8_t> &commands);
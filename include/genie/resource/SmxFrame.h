@@ -80,6 +80,24 @@ public:
   size_t load(std::istream &istr);
   void save(std::ostream &ostr);
 
+  //----------------------------------------------------------------------------
+  /// Unpacks block_count 4plus1 blocks of five bytes into four pixels each.
+  //
+  typedef void (*Unpack4Plus1)(const uint8_t *packed, size_t block_count,
+                               uint16_t *pixels);
+
+  struct Unpacker4Plus1
+  {
+    const char *name;
+    Unpack4Plus1 unpack;
+  };
+
+  //----------------------------------------------------------------------------
+  /// 4plus1 unpackers this cpu runs, the scalar one first and the one used
+  /// by load() last. Lets tests check every kernel against the scalar one.
+  //
+  static std::vector<Unpacker4Plus1> get4Plus1Unpackers(void);
+
   //----------------------------------------------------------------------------
   /// Get image's width.
   //
@@ -0,0 +1,152 @@
+/*
+    genieutils - A library for reading and writing data files of genie
+               engine games.
+    Copyright (C) 2011 - 2013  Armin Preiml
+    Copyright (C) 2011 - 2021  Mikko "Tapsa" P
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GENIE_SPRITECACHE_H
+#define GENIE_SPRITECACHE_H
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "SpriteFile.h"
+
+namespace genie
+{
+
+//------------------------------------------------------------------------------
+/// Keeps the decoded frames of several sprite files within a byte budget.
+/// When the budget is exceeded the least recently used frames are evicted
+/// from their files, which keep their headers and data and decode them again
+/// on the next access.
+///
+/// Sprite files report to the cache themselves, see SlpFile::setSpriteCache
+/// and DrsFile::setSpriteCache. A file has to outlive its cache or be
+/// unloaded before the cache is destroyed.
+//
+class SpriteCache
+{
+public:
+  //----------------------------------------------------------------------------
+  /// @param budget bytes of decoded frames to keep, 0 for no limit
+  //
+  SpriteCache(size_t budget = 0);
+  virtual ~SpriteCache();
+
+  //----------------------------------------------------------------------------
+  /// Cache shared by all archives of the process. Has no budget until one
+  /// is set.
+  //
+  static SpriteCache &getGlobalCache(void);
+
+  //----------------------------------------------------------------------------
+  /// Sets the byte budget, evicting frames if the cache is over it.
+  ///
+  /// @param budget bytes of decoded frames to keep, 0 for no limit
+  //
+  void setBudget(size_t budget);
+  size_t getBudget(void) const;
+
+  //----------------------------------------------------------------------------
+  /// Bytes of decoded frames currently held.
+  //
+  size_t getSize(void) const;
+
+  //----------------------------------------------------------------------------
+  /// Frame accesses served from decoded frames, accesses that had to decode
+  /// and frames evicted since construction or the last resetCounters().
+  //
+  uint64_t getHits(void) const;
+  uint64_t getMisses(void) const;
+  uint64_t getEvictions(void) const;
+  void resetCounters(void);
+
+  //----------------------------------------------------------------------------
+  /// Evicts all frames.
+  //
+  void clear(void);
+
+  //----------------------------------------------------------------------------
+  /// Records an access to an already decoded frame.
+  //
+  void touch(SpriteFile *file, uint16_t frame);
+
+  //----------------------------------------------------------------------------
+  /// Records a frame that was just decoded, evicting older frames if the
+  /// budget is exceeded. The file must not hold any of its own locks here.
+  ///
+  /// @param bytes memory used by the decoded frame
+  //
+  void insert(SpriteFile *file, uint16_t frame, size_t bytes);
+
+  //----------------------------------------------------------------------------
+  /// Forgets all frames of a file without evicting them. Called by files
+  /// being unloaded or destroyed.
+  //
+  void remove(SpriteFile *file);
+
+private:
+  struct Entry
+  {
+    SpriteFile *file;
+    uint16_t frame;
+    size_t bytes;
+  };
+
+  typedef std::list<Entry> EntryList;
+
+  struct KeyHash
+  {
+    size_t operator()(const std::pair<SpriteFile *, uint16_t> &key) const
+    {
+      return std::hash<SpriteFile *>()(key.first) ^ (size_t(key.second) << 1);
+    }
+  };
+
+  typedef std::unordered_map<std::pair<SpriteFile *, uint16_t>,
+    EntryList::iterator, KeyHash> EntryMap;
+
+  mutable std::mutex mutex_;
+
+  size_t budget_;
+  size_t size_ = 0;
+
+  /// Most recently used frames first.
+  EntryList entries_;
+  EntryMap index_;
+
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  uint64_t evictions_ = 0;
+
+  //----------------------------------------------------------------------------
+  /// Evicts the oldest frames till the budget is met, never the newest one.
+  //
+  void evictOverBudget(void);
+
+  //----------------------------------------------------------------------------
+  void evict(EntryList::iterator entry);
+};
+
+}
+
+#endif // GENIE_SPRITECACHE_H
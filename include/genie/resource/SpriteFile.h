@@ -51,7 +51,13 @@ public:
 
   /// Return approximate size in memory.
   /// @return bytes of memory consumed.
-  size_t getSizeInMemory(void) const { return size_in_memory_; }
+  virtual size_t getSizeInMemory(void) const { return size_in_memory_; }
+
+  /// Drops the decoded data of the given frame, so it is decoded again on
+  /// its next access. Used by SpriteCache, sprites that can't decode a frame
+  /// again ignore it.
+  /// @return bytes of memory freed.
+  virtual size_t evictFrame(uint16_t) { return 0; }
 
 protected:
   size_t size_in_memory_ = 0;
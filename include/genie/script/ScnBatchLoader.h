@@ -0,0 +1,138 @@
+/*
+    genieutils - A library for reading and writing data files of genie
+               engine games.
+    Copyright (C) 2011 - 2013  Armin Preiml
+    Copyright (C) 2011 - 2021  Mikko "Tapsa" P
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GENIE_SCNBATCHLOADER_H
+#define GENIE_SCNBATCHLOADER_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ScnFile.h"
+
+namespace genie
+{
+
+//------------------------------------------------------------------------------
+/// Loads many scenario files in parallel. Files are spread over the threads
+/// of WorkerPool::getGlobalPool(), idle threads steal files queued for busy
+/// ones.
+//
+class ScnBatchLoader
+{
+public:
+  //----------------------------------------------------------------------------
+  /// Outcome of loading one file.
+  //
+  struct Result
+  {
+    /// Index of the file in the paths passed to load().
+    size_t index = 0;
+
+    std::string path;
+
+    /// Loaded scenario, null if loading failed.
+    std::shared_ptr<ScnFile> file;
+
+    /// Reason of the failure, empty on success.
+    std::string error;
+  };
+
+  //----------------------------------------------------------------------------
+  /// Receives each result as soon as its file is done. Called on the worker
+  /// threads, but never twice at the same time. Whatever the sink doesn't
+  /// move out of the result is freed when it returns.
+  //
+  typedef std::function<void(Result &result)> ResultSink;
+
+  //----------------------------------------------------------------------------
+  /// Default of setMemoryPerFileByte(). A rough estimate, the real ratio
+  /// depends on how well the files compress and should be set for the
+  /// files at hand.
+  //
+  static const size_t DEFAULT_MEMORY_PER_FILE_BYTE = 10;
+
+  //----------------------------------------------------------------------------
+  /// @param threadCount number of threads, 0 to use one per core
+  /// @param memoryLimit estimated bytes of memory used by the files in
+  ///                    flight, 0 for no limit
+  //
+  ScnBatchLoader(unsigned int threadCount = 0, size_t memoryLimit = 0);
+  virtual ~ScnBatchLoader();
+
+  //----------------------------------------------------------------------------
+  void setThreadCount(unsigned int threadCount);
+  unsigned int getThreadCount(void) const;
+
+  //----------------------------------------------------------------------------
+  /// Limits the memory used by the files in flight. A file is in flight
+  /// from the start of its parsing until the result sink returns, and is
+  /// accounted by its size on disk times getMemoryPerFileByte(). A file
+  /// over the limit is still loaded, but only while nothing else is in
+  /// flight.
+  ///
+  /// @param memoryLimit limit in bytes, 0 for no limit
+  //
+  void setMemoryLimit(size_t memoryLimit);
+  size_t getMemoryLimit(void) const;
+
+  //----------------------------------------------------------------------------
+  /// Estimated bytes of memory a loaded scenario takes per byte of the file
+  /// on disk. Covers the inflated data and the objects parsed from it.
+  ///
+  /// @param bytes estimate, DEFAULT_MEMORY_PER_FILE_BYTE by default
+  //
+  void setMemoryPerFileByte(size_t bytes);
+  size_t getMemoryPerFileByte(void) const;
+
+  //----------------------------------------------------------------------------
+  /// Loads all given files and hands each result to the sink. Blocks until
+  /// every file is loaded or failed. The memory limit holds for the whole
+  /// batch as long as the sink drops or hands off the scenarios.
+  ///
+  /// If the sink throws, no more files are started and the exception is
+  /// rethrown once the workers are done.
+  ///
+  /// @param paths files to load
+  /// @param sink receives one result per path, in no particular order
+  //
+  void load(const std::vector<std::string> &paths, const ResultSink &sink);
+
+  //----------------------------------------------------------------------------
+  /// Loads all given files. Blocks until every file is loaded or failed.
+  /// All scenarios are kept until the call returns, so the memory limit
+  /// only bounds the files being parsed. Use the sink version for large
+  /// batches.
+  ///
+  /// @param paths files to load
+  /// @return one result per path, in the same order
+  //
+  std::vector<Result> load(const std::vector<std::string> &paths);
+
+private:
+  unsigned int threadCount_;
+  size_t memoryLimit_;
+  size_t memoryPerFileByte_ = DEFAULT_MEMORY_PER_FILE_BYTE;
+};
+
+}
+
+#endif // GENIE_SCNBATCHLOADER_H
@@ -62,9 +62,27 @@ public:
   //
   void extractRaw(const char *from, const char *to);
 
+  //----------------------------------------------------------------------------
+  /// Saves through one pre-sized buffer, see IFile::saveBuffered.
+  //
+  void saveAs(const char *fileName) override;
+
+  //----------------------------------------------------------------------------
+  /// Reads only the uncompressed header, up to playerCount, which is enough
+  /// to list a scenario. Nothing is inflated and the file is closed again.
+  /// Other members are left as they are. The file name is not kept, so
+  /// save() doesn't write to the peeked file.
+  ///
+  /// @param fileName file name
+  /// @param playerNames also inflate as much as needed to read nextUnitID
+  ///                    and playerData.playerNames (version 1.14 and later)
+  /// @exception std::ios_base::failure thrown if file can't be read
+  //
+  void peekHeader(const char *fileName, bool playerNames = false);
+
   static uint32_t getSeparator(void);
 
-  std::string version;
+  std::string version = "0.00";
 
   // Uncompressed Header:
 
@@ -93,7 +111,7 @@ public:
 
   std::vector<ScnMorePlayerData> players;
 
-  double triggerVersion;
+  double triggerVersion = 0.0;
   uint8_t objectivesStartingState;
   std::vector<Trigger> triggers;
   std::vector<int32_t> triggerDisplayOrder;
@@ -110,6 +128,16 @@ private:
   uint32_t numTriggers_;
   uint32_t fileCount_;
 
+  enum Peek
+  {
+    PEEK_NONE,
+    PEEK_HEADER,
+    PEEK_PLAYER_NAMES
+  };
+
+  /// Part read by the next load, set by peekHeader.
+  Peek peek_ = PEEK_NONE;
+
   Compressor compressor_;
 
   virtual void serializeObject(void);
@@ -24,24 +24,45 @@
 
 #include "genie/file/ISerializable.h"
 #include <stdint.h>
+#include <vector>
 
 namespace genie
 {
 
-class MapTile : public ISerializable
+/// Values of one tile, as handed out by ScnMap.
+struct MapTile
 {
-public:
-  MapTile();
-  virtual ~MapTile();
-
   uint8_t terrainID = 0;
   uint8_t elevation = 0;
 
   /// always 0
   uint8_t unused = 0;
+};
 
-private:
-  virtual void serializeObject(void);
+/// Values of one tile, referring to the arrays of a ScnMap. Assigning a
+/// MapTile or a member writes to the map.
+struct MapTileRef
+{
+  uint8_t &terrainID;
+  uint8_t &elevation;
+  uint8_t &unused;
+
+  inline operator MapTile(void) const
+  {
+    MapTile tile;
+    tile.terrainID = terrainID;
+    tile.elevation = elevation;
+    tile.unused = unused;
+    return tile;
+  }
+
+  inline MapTileRef &operator=(const MapTile &tile)
+  {
+    terrainID = tile.terrainID;
+    elevation = tile.elevation;
+    unused = tile.unused;
+    return *this;
+  }
 };
 
 /// Naming it ScnMap because it may be used elsewhere
@@ -49,15 +70,63 @@ class ScnMap : public ISerializable
 {
 public:
   ScnMap();
+  ScnMap(const ScnMap &other);
+  ScnMap &operator=(const ScnMap &other);
   virtual ~ScnMap();
 
+  /// Per tile view over the tile arrays, tiles[i].terrainID works as it did
+  /// when tiles were stored as objects. The number of tiles is changed
+  /// through resize().
+  class Tiles
+  {
+  public:
+    inline MapTileRef operator[](size_t index)
+    {
+      return {map_->terrainIDs[index], map_->elevations[index],
+              map_->unused[index]};
+    }
+
+    inline MapTile operator[](size_t index) const
+    {
+      return map_->getTile(index);
+    }
+
+    inline size_t size(void) const { return map_->getTileCount(); }
+    inline bool empty(void) const { return size() == 0; }
+
+  private:
+    friend class ScnMap;
+
+    explicit Tiles(ScnMap *map) : map_(map) {}
+    Tiles(const Tiles &) = delete;
+    Tiles &operator=(const Tiles &) = delete;
+
+    ScnMap *map_;
+  };
+
   /// AoK caps at 256
   uint32_t width = 0;
 
   /// AoK caps at 256
   uint32_t height = 0;
 
-  std::vector<MapTile> tiles;
+  /// Tiles row by row, one array per tile value. All have width * height
+  /// entries.
+  std::vector<uint8_t> terrainIDs;
+  std::vector<uint8_t> elevations;
+  std::vector<uint8_t> unused;
+
+  Tiles tiles;
+
+  /// Number of tiles.
+  size_t getTileCount(void) const;
+
+  /// Tile at index y * width + x.
+  MapTile getTile(size_t index) const;
+  void setTile(size_t index, const MapTile &tile);
+
+  /// Sets the map size, keeping tiles by index and adding zeroed ones.
+  void resize(uint32_t width, uint32_t height);
 
 private:
   virtual void serializeObject(void);
@@ -48,7 +48,6 @@ public:
   uint32_t ore;
   uint32_t goods;
 
-  static bool playerInfo;
 private:
   virtual void serializeObject(void);
 };
@@ -141,7 +140,7 @@ public:
   ScnMainPlayerData();
   virtual ~ScnMainPlayerData();
 
-  float playerDataVersion;
+  float playerDataVersion = 0.f;
   static float version;
   std::vector<std::string> playerNames;
   std::vector<int32_t> playerNamesStringTable;
@@ -0,0 +1,112 @@
+/*
+    genieutils - A library for reading and writing data files of genie
+               engine games.
+    Copyright (C) 2011 - 2013  Armin Preiml
+    Copyright (C) 2011 - 2021  Mikko "Tapsa" P
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GENIE_WORKERPOOL_H
+#define GENIE_WORKERPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace genie
+{
+
+//------------------------------------------------------------------------------
+/// Threads shared by everything that works in parallel, like frame
+/// decoding, section saving and batch loading. Workers are started when a
+/// job first asks for them and are kept for later jobs.
+///
+/// The thread calling run() always works on its own job too, and only waits
+/// for items that workers already took. So jobs may run further jobs from
+/// inside, like the rows of a frame decoded as part of decoding all frames,
+/// without waiting for free workers.
+//
+class WorkerPool
+{
+public:
+  WorkerPool();
+
+  //----------------------------------------------------------------------------
+  /// Waits for the workers to finish the items they took.
+  //
+  virtual ~WorkerPool();
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  //----------------------------------------------------------------------------
+  /// Pool shared by the whole process.
+  //
+  static WorkerPool &getGlobalPool(void);
+
+  //----------------------------------------------------------------------------
+  /// @return number of workers started so far, not counting threads calling
+  ///         run()
+  //
+  unsigned int getThreadCount(void);
+
+  //----------------------------------------------------------------------------
+  /// Calls job(i) for every i below count and blocks until all calls are
+  /// done. Items are handed out in order to the calling thread and to up to
+  /// threadCount - 1 workers. Missing workers are started first, if that
+  /// fails the job runs on the workers there are.
+  ///
+  /// If a call throws, the items not started yet are skipped and the first
+  /// exception is rethrown once the started ones are done.
+  ///
+  /// @param count number of items
+  /// @param threadCount threads working on the job at most, counting the
+  ///                    calling thread. 0 for one per core.
+  /// @param job function called for each item
+  //
+  void run(size_t count, unsigned int threadCount,
+           const std::function<void(size_t)> &job);
+
+  //----------------------------------------------------------------------------
+  /// Number of threads to use for a thread count setting, where 0 means one
+  /// per core.
+  //
+  static unsigned int resolveThreadCount(unsigned int threadCount);
+
+private:
+  struct Job;
+
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable queued_;
+  std::deque<std::shared_ptr<Job>> queue_;
+  bool stopping_ = false;
+
+  void workerLoop(void);
+
+  //----------------------------------------------------------------------------
+  /// Works on items of the job until none are left to take.
+  //
+  static void work(Job &job);
+};
+
+}
+
+#endif // GENIE_WORKERPOOL_H
@@ -19,6 +19,7 @@
 */
 
 #include "genie/dat/Civ.h"
+#include "genie/dat/UnitPool.h"
 
 namespace genie
 {
@@ -36,6 +37,45 @@ void Civ::setGameVersion(GameVersion gv)
   ISerializable::setGameVersion(gv);
 
   updateGameVersion(Units);
+
+  for (std::shared_ptr<Unit> &unit: SharedUnits)
+    unit->setGameVersion(gv);
+}
+
+size_t Civ::getUnitCount(void) const
+{
+  return SharedUnits.empty() ? Units.size() : SharedUnits.size();
+}
+
+const Unit &Civ::getUnit(size_t index) const
+{
+  return SharedUnits.empty() ? Units[index] : *SharedUnits[index];
+}
+
+Unit &Civ::editUnit(size_t index)
+{
+  if (SharedUnits.empty())
+    return Units[index];
+
+  std::shared_ptr<Unit> &unit = SharedUnits[index];
+
+  if (unit.use_count() > 1)
+    unit = std::make_shared<Unit>(*unit);
+
+  return *unit;
+}
+
+void Civ::unshareUnits(void)
+{
+  if (SharedUnits.empty())
+    return;
+
+  Units.resize(SharedUnits.size());
+
+  for (size_t i = 0; i < SharedUnits.size(); ++i)
+    Units[i] = *SharedUnits[i];
+
+  SharedUnits.clear();
 }
 
 unsigned short Civ::getNameSize(void)
@@ -80,9 +120,47 @@ void Civ::serializeObject(void)
 
   serialize<uint8_t>(IconSet);
 
-  serializeSize<int16_t>(count, Units.size());
+  serializeSize<int16_t>(count, getUnitCount());
   serialize<int32_t>(UnitPointers, count);
-  serializeSubWithPointers<Unit>(Units, count, UnitPointers);
+
+  if (isOperation(OP_READ) ? getContext().unit_pool != 0 : !SharedUnits.empty())
+  {
+    serializeSharedUnits(count);
+  }
+  else
+  {
+    SharedUnits.clear();
+    serializeSubWithPointers<Unit>(Units, count, UnitPointers);
+  }
+}
+
+void Civ::serializeSharedUnits(size_t count)
+{
+  if (!isOperation(OP_READ))
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      if (UnitPointers[i])
+        SharedUnits[i]->serializeSubObject(this);
+    }
+    return;
+  }
+
+  UnitPool &pool = *getContext().unit_pool;
+
+  Units.clear();
+  SharedUnits.resize(count);
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    Unit unit;
+    unit.setGameVersion(getGameVersion());
+
+    if (UnitPointers[i])
+      unit.serializeSubObject(this);
+
+    SharedUnits[i] = pool.share(unit);
+  }
 }
 
 }
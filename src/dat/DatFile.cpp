@@ -23,15 +23,105 @@
 
 #include "genie/dat/DatFile.h"
 
+#include <cstdio>
 #include <fstream>
+#include <memory>
 #include <vector>
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
 #include "genie/Types.h"
+#include "genie/dat/DatIndex.h"
+#include "genie/dat/UnitPool.h"
+#include "genie/util/WorkerPool.h"
 
 namespace genie
 {
 
-float ISerializable::dat_internal_ver = 0.f;
+namespace
+{
+
+//------------------------------------------------------------------------------
+/// Writes a section of a dat file into its own buffer.
+//
+class SectionWriter : public ISerializable
+{
+public:
+  SectionWriter(std::vector<ISerializable *> objects,
+                const SerializationContext &context) :
+    objects_(objects), parent_context_(context)
+  {
+  }
+
+private:
+  std::vector<ISerializable *> objects_;
+  SerializationContext parent_context_;
+
+  virtual void serializeObject(void)
+  {
+    getContext() = parent_context_;
+
+    for (ISerializable *data : objects_)
+      data->serializeSubObject(this);
+  }
+};
+
+//------------------------------------------------------------------------------
+/// Leads a snapshot, ties it to the dat file it was made of.
+//
+class SnapshotHeader : public ISerializable
+{
+public:
+  /// Raised whenever the layout of the serialized data changes.
+  static const uint32_t FORMAT_VERSION = 1;
+
+  std::string Magic = "GDSN";
+  uint32_t FormatVersion = FORMAT_VERSION;
+
+  uint32_t DatHash = 0;
+  uint32_t DatSize = 0;
+
+  /// Bytes following the header.
+  uint32_t DataSize = 0;
+
+  /// Version set before loading the dat and the one it resolved to.
+  int32_t LoadVersion = GV_None;
+  int32_t DatVersion = GV_None;
+
+private:
+  virtual void serializeObject(void)
+  {
+    serialize(Magic, 4);
+    serializeFields(FormatVersion, DatHash, DatSize, DataSize, LoadVersion,
+      DatVersion);
+  }
+};
+
+}
+
+//------------------------------------------------------------------------------
+/// Output split into chunks in file order. Every other chunk belongs to a
+/// section, the ones between take what DatFile writes itself.
+//
+struct DatFile::SectionQueue
+{
+  struct Section
+  {
+    std::unique_ptr<SectionWriter> writer;
+    WriteBuffer *buffer;
+  };
+
+  WriteBuffer *output;
+  std::vector<std::unique_ptr<WriteBuffer>> chunks;
+  std::vector<Section> sections;
+
+  WriteBuffer *addChunk(void)
+  {
+    chunks.emplace_back(new WriteBuffer());
+    return chunks.back().get();
+  }
+};
 
 //------------------------------------------------------------------------------
 DatFile::DatFile() : compressor_(this)
@@ -63,6 +153,181 @@ void DatFile::setGameVersion(GameVersion gv)
   TechTree.setGameVersion(gv);
 }
 
+//------------------------------------------------------------------------------
+void DatFile::saveAs(const char *fileName)
+{
+  saveBuffered(fileName);
+}
+
+//------------------------------------------------------------------------------
+void DatFile::saveSnapshot(const char *fileName)
+{
+  if (load_sections_ != Sections::All)
+    throw std::ios_base::failure("Snapshot needs all sections loaded");
+
+  SnapshotHeader header;
+  header.DatHash = DatIndex::hashFile(getFileName(), &header.DatSize);
+  header.LoadVersion = load_version_;
+  header.DatVersion = getGameVersion();
+  header.DataSize = static_cast<uint32_t>(objectSize());
+
+  WriteBuffer buffer(header.objectSize() + header.DataSize);
+
+  compressor_.setPassThrough(true);
+
+  try
+  {
+    header.writeObject(buffer);
+    writeObject(buffer);
+  }
+  catch (...)
+  {
+    compressor_.setPassThrough(false);
+    throw;
+  }
+
+  compressor_.setPassThrough(false);
+
+  // Other processes may be loading the snapshot, so it is replaced at once.
+  std::string tempName = std::string(fileName) + ".tmp";
+  std::ofstream file(tempName, std::ofstream::binary);
+
+  file.write(buffer.data.data(), buffer.size());
+  file.close();
+
+  if (file.fail())
+  {
+    std::remove(tempName.c_str());
+    throw std::ios_base::failure("Cant write to file: \"" + tempName + "\"");
+  }
+
+  if (std::rename(tempName.c_str(), fileName) != 0)
+  {
+    // Windows doesn't replace existing files.
+    std::remove(fileName);
+
+    if (std::rename(tempName.c_str(), fileName) != 0)
+    {
+      std::remove(tempName.c_str());
+      throw std::ios_base::failure("Cant write to file: \"" +
+                                   std::string(fileName) + "\"");
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+bool DatFile::loadSnapshot(const char *fileName, const char *datFileName)
+{
+  using namespace boost::interprocess;
+
+  file_mapping file;
+  mapped_region region;
+
+  try
+  {
+    file = file_mapping(fileName, read_only);
+    region = mapped_region(file, read_only);
+  }
+  catch (interprocess_exception &)
+  {
+    return false;
+  }
+
+  const char *data = static_cast<const char *>(region.get_address());
+  ReadBuffer buffer(data, data + region.get_size());
+
+  SnapshotHeader header;
+
+  if (region.get_size() < header.objectSize())
+    return false;
+
+  header.readObject(buffer);
+
+  // Reading past the end of a cut off snapshot would not fail, so its size
+  // is checked up front.
+  if (header.Magic != "GDSN" ||
+      header.FormatVersion != SnapshotHeader::FORMAT_VERSION ||
+      header.DataSize != static_cast<size_t>(buffer.end - buffer.pos) ||
+      header.LoadVersion != getGameVersion())
+    return false;
+
+  uint32_t size;
+  uint32_t hash;
+
+  try
+  {
+    hash = DatIndex::hashFile(datFileName, &size);
+  }
+  catch (const std::ios_base::failure &)
+  {
+    return false;
+  }
+
+  if (hash != header.DatHash || size != header.DatSize)
+    return false;
+
+  freelock();
+  setFileName(datFileName);
+  setGameVersion(static_cast<GameVersion>(header.DatVersion));
+
+  // Reading starts over from the beginning of the buffer.
+  ReadBuffer body(buffer.pos, buffer.end);
+
+  compressor_.setPassThrough(true);
+
+  try
+  {
+    readObject(body);
+  }
+  catch (...)
+  {
+    compressor_.setPassThrough(false);
+    setGameVersion(static_cast<GameVersion>(header.LoadVersion));
+    throw;
+  }
+
+  compressor_.setPassThrough(false);
+  load_version_ = static_cast<GameVersion>(header.LoadVersion);
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void DatFile::loadCached(const char *fileName)
+{
+  std::string snapshot = getSnapshotName(fileName);
+
+  try
+  {
+    if (loadSnapshot(snapshot.c_str(), fileName))
+      return;
+  }
+  catch (const std::exception &)
+  {
+    // Damaged snapshot, replaced below.
+  }
+
+  load(fileName);
+
+  if (load_sections_ != Sections::All)
+    return;
+
+  try
+  {
+    saveSnapshot(snapshot.c_str());
+  }
+  catch (const std::ios_base::failure &)
+  {
+    // The dat is loaded, the next start just has to inflate it again.
+  }
+}
+
+//------------------------------------------------------------------------------
+std::string DatFile::getSnapshotName(const char *datFileName)
+{
+  return std::string(datFileName) + ".snap";
+}
+
 //------------------------------------------------------------------------------
 void DatFile::extractRaw(const char *inFile, const char *outFile)
 {
@@ -78,17 +343,34 @@ void DatFile::extractRaw(const char *inFile, const char *outFile)
   ofs.close();
 }
 
+//------------------------------------------------------------------------------
+void DatFile::load(const char *fileName, uint32_t sections)
+{
+  load_sections_ = sections;
+
+  IFile::load(fileName);
+}
+
 //------------------------------------------------------------------------------
 void DatFile::setVerboseMode(bool verbose)
 {
   verbose_ = verbose;
 }
 
+//------------------------------------------------------------------------------
+void DatFile::setSaveThreadCount(unsigned int count)
+{
+  save_threads_ = count;
+}
+
 //------------------------------------------------------------------------------
 void DatFile::serializeObject(void)
 {
   compressor_.beginCompression();
 
+  if (isOperation(OP_READ))
+    load_version_ = getGameVersion();
+
   serialize(FileVersion, FILE_VERSION_SIZE);
 
   // Handle all different versions while in development.
@@ -147,13 +429,15 @@ void DatFile::serializeObject(void)
   int16_t count16;
   int32_t count32;
 
+  if (isOperation(OP_READ))
+    section_offsets_.assign(Sections::COUNT, UINT32_MAX);
+
+  beginSections();
+
   if (gv >= GV_SWGB)
   {
     serializeSize<int16_t>(count16, Civs.size());
-    serialize<int32_t>(SUnknown2);
-    serialize<int32_t>(SUnknown3);
-    serialize<int32_t>(SUnknown4);
-    serialize<int32_t>(SUnknown5);
+    serializeFields(SUnknown2, SUnknown3, SUnknown4, SUnknown5);
 
     if (verbose_)
     {
@@ -180,32 +464,32 @@ void DatFile::serializeObject(void)
   if (gv >= GV_AoKA)
     serialize<int32_t>(TerrainPassGraphicPointers, count16);
 
-  TerrainRestriction::setTerrainCount(TerrainsUsed1);
-  serializeSub<TerrainRestriction>(TerrainRestrictions, count16);
+  getContext().terrain_count = TerrainsUsed1;
+  serializeSection(Sections::TerrainRestrictions, TerrainRestrictions, count16);
 
   serializeSize<int16_t>(count16, PlayerColours.size());
 
   if (verbose_)
     std::cout << "PlayerColours: " << count16 << std::endl;
 
-  serializeSub<PlayerColour>(PlayerColours, count16);
+  serializeSection(Sections::PlayerColours, PlayerColours, count16);
 
   serializeSize<int16_t>(count16, Sounds.size());
 
   if (verbose_)
     std::cout << "Sounds: " << count16 << std::endl;
 
-  serializeSub<Sound>(Sounds, count16);
+  serializeSection(Sections::Sounds, Sounds, count16);
 
   serializeSize<int16_t>(count16, Graphics.size());
   if (gv < GV_AoE)
   {
-    serializeSub<Graphic>(Graphics, count16);
+    serializeSection(Sections::Graphics, Graphics, count16);
   }
   else
   {
     serialize<int32_t>(GraphicPointers, count16);
-    serializeSubWithPointers<Graphic>(Graphics, count16, GraphicPointers);
+    serializeSectionWithPointers(Sections::Graphics, Graphics, count16, GraphicPointers);
   }
 
   auto pos_cnt = tellg();
@@ -213,7 +497,7 @@ void DatFile::serializeObject(void)
   {
     std::cout << "Graphics: " << Graphics.size() << std::endl;
   }
-  serialize<ISerializable>(TerrainBlock);
+  serializeSection(Sections::TerrainBlock, TerrainBlock);
 
   if (verbose_)
   {
@@ -225,19 +509,19 @@ void DatFile::serializeObject(void)
   // This data seems to be needed only in AoE and RoR.
   // In later games it is removable.
   // It exists in Star Wars games too, but is not used.
-  serialize<ISerializable>(RandomMaps);
+  serializeSection(Sections::RandomMaps, RandomMaps);
 
   serializeSize<int32_t>(count32, Effects.size());
 
   if (verbose_)
     std::cout << "Effects: " << count32 << std::endl;
 
-  serializeSub<Effect>(Effects, count32);
+  serializeSection(Sections::Effects, Effects, count32);
 
   if (gv >= GV_SWGB) //pos: 0x111936
   {
     serializeSize<int16_t>(count16, UnitLines.size());
-    serializeSub<UnitLine>(UnitLines, count16);
+    serializeSection(Sections::UnitLines, UnitLines, count16);
   }
 
   if (gv >= GV_AoK)
@@ -247,7 +531,7 @@ void DatFile::serializeObject(void)
     if (verbose_)
       std::cout << "Units: " << count32 << std::endl;
 
-    serializeSub<UnitHeader>(UnitHeaders, count32);
+    serializeSection(Sections::UnitHeaders, UnitHeaders, count32);
   }
 
   serializeSize<int16_t>(count16, Civs.size());
@@ -255,7 +539,18 @@ void DatFile::serializeObject(void)
   if (verbose_)
     std::cout << "Civs: " << count16 << std::endl;
 
-  serializeSub<Civ>(Civs, count16);
+  UnitPool unit_pool;
+  bool shared_units = false;
+
+  if (isOperation(OP_READ) && share_units_)
+    getContext().unit_pool = &unit_pool;
+
+  for (const Civ &civ: Civs)
+    shared_units = shared_units || !civ.SharedUnits.empty();
+
+  // Shared units can't be written by several threads at once.
+  serializeSection(Sections::Civs, Civs, count16, !shared_units);
+  getContext().unit_pool = 0;
 
   if (gv >= GV_SWGB)
     serialize<uint8_t>(SUnknown7);
@@ -265,7 +560,7 @@ void DatFile::serializeObject(void)
   if (verbose_)
     std::cout << "Techs: " << count16 << std::endl;
 
-  serializeSub<Tech>(Techs, count16);
+  serializeSection(Sections::Techs, Techs, count16);
 
   if (verbose_)
   {
@@ -278,15 +573,10 @@ void DatFile::serializeObject(void)
 
   if (gv >= GV_AoKA) // 9.38
   {
-    serialize<int32_t>(TimeSlice);
-    serialize<int32_t>(UnitKillRate);
-    serialize<int32_t>(UnitKillTotal);
-    serialize<int32_t>(UnitHitPointRate);
-    serialize<int32_t>(UnitHitPointTotal);
-    serialize<int32_t>(RazingKillRate);
-    serialize<int32_t>(RazingKillTotal);
+    serializeFields(TimeSlice, UnitKillRate, UnitKillTotal, UnitHitPointRate,
+      UnitHitPointTotal, RazingKillRate, RazingKillTotal);
 
-    serialize<ISerializable>(TechTree);
+    serializeSection(Sections::TechTree, TechTree);
   }
 
   if (verbose_)
@@ -295,9 +585,93 @@ void DatFile::serializeObject(void)
     std::cout << " to 0x" << tellg() << std::dec << ") size " << pos_cnt << std::endl;
   }
 
+  endSections();
+
   compressor_.endCompression();
 }
 
+//------------------------------------------------------------------------------
+uint32_t DatFile::getSectionOffset(uint32_t section) const
+{
+  for (unsigned int i = 0; i < section_offsets_.size(); ++i)
+  {
+    if (section == (1u << i))
+      return section_offsets_[i];
+  }
+
+  return UINT32_MAX;
+}
+
+//------------------------------------------------------------------------------
+void DatFile::markSection(uint32_t section)
+{
+  if (!isOperation(OP_READ))
+    return;
+
+  for (unsigned int i = 0; i < Sections::COUNT; ++i)
+  {
+    if (section == (1u << i))
+      section_offsets_[i] = static_cast<uint32_t>(tellg());
+  }
+}
+
+//------------------------------------------------------------------------------
+void DatFile::beginSections(void)
+{
+  if (!isOperation(OP_WRITE) || !getWriteBuffer() || save_threads_ == 1)
+    return;
+
+  sections_.reset(new SectionQueue());
+  sections_->output = getWriteBuffer();
+
+  setWriteBuffer(sections_->addChunk());
+}
+
+//------------------------------------------------------------------------------
+void DatFile::queueSection(std::vector<ISerializable *> objects)
+{
+  SectionQueue::Section section;
+
+  section.writer.reset(new SectionWriter(objects, getContext()));
+  section.writer->setGameVersion(getGameVersion());
+  section.buffer = sections_->addChunk();
+
+  sections_->sections.push_back(std::move(section));
+
+  setWriteBuffer(sections_->addChunk());
+}
+
+//------------------------------------------------------------------------------
+void DatFile::endSections(void)
+{
+  if (!sections_)
+    return;
+
+  std::unique_ptr<SectionQueue> queue(std::move(sections_));
+
+  setWriteBuffer(queue->output);
+
+  std::vector<SectionQueue::Section> &sections = queue->sections;
+
+  WorkerPool::getGlobalPool().run(sections.size(),
+    WorkerPool::resolveThreadCount(save_threads_), [&](size_t i) {
+      sections[i].writer->writeObject(*sections[i].buffer);
+    });
+
+  size_t size = 0;
+  for (const std::unique_ptr<WriteBuffer> &chunk : queue->chunks)
+  {
+    size += chunk->size();
+  }
+
+  queue->output->reserve(size);
+
+  for (const std::unique_ptr<WriteBuffer> &chunk : queue->chunks)
+  {
+    queue->output->write(chunk->data.data(), chunk->size());
+  }
+}
+
 //------------------------------------------------------------------------------
 void DatFile::unload()
 {
@@ -0,0 +1,254 @@
+/*
+    geniedat - A library for reading and writing data files of genie
+               engine games.
+    Copyright (C) 2011 - 2013  Armin Preiml
+    Copyright (C) 2011 - 2021  Mikko "Tapsa" P
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "genie/dat/DatIndex.h"
+
+#include <fstream>
+#include <zlib.h>
+
+namespace genie
+{
+
+const uint32_t DatIndex::NO_OFFSET;
+
+//------------------------------------------------------------------------------
+DatIndex::DatIndex()
+{
+}
+
+//------------------------------------------------------------------------------
+DatIndex::~DatIndex()
+{
+}
+
+//------------------------------------------------------------------------------
+void DatIndex::build(DatFile &dat)
+{
+  DatHash = hashFile(dat.getFileName(), &DatSize);
+  LoadVersion = dat.getLoadVersion();
+  DatVersion = dat.getGameVersion();
+
+  SectionOffsets.resize(DatFile::Sections::COUNT);
+  for (unsigned int i = 0; i < DatFile::Sections::COUNT; ++i)
+    SectionOffsets[i] = dat.getSectionOffset(1u << i);
+
+  // Records follow each other, so their offsets add up from the start of
+  // their section. Records of sections that were not read keep NO_OFFSET.
+  uint32_t offset = getSectionOffset(DatFile::Sections::Civs);
+  CivOffsets.assign(dat.Civs.size(), NO_OFFSET);
+  UnitOffsets.assign(dat.Civs.size(), std::vector<uint32_t>());
+  for (size_t i = 0; offset != NO_OFFSET && i < dat.Civs.size(); ++i)
+  {
+    Civ &civ = dat.Civs[i];
+    CivOffsets[i] = offset;
+    offset += static_cast<uint32_t>(civ.objectSize());
+
+    // Units are the last part of a civ.
+    std::vector<uint32_t> unit_sizes(civ.getUnitCount(), 0);
+    uint32_t units_size = 0;
+    for (size_t j = 0; j < unit_sizes.size(); ++j)
+    {
+      if (civ.UnitPointers[j])
+      {
+        Unit &unit = civ.SharedUnits.empty() ? civ.Units[j] : *civ.SharedUnits[j];
+        unit_sizes[j] = static_cast<uint32_t>(unit.objectSize());
+        units_size += unit_sizes[j];
+      }
+    }
+
+    uint32_t unit_offset = offset - units_size;
+    UnitOffsets[i].assign(unit_sizes.size(), NO_OFFSET);
+    for (size_t j = 0; j < unit_sizes.size(); ++j)
+    {
+      if (civ.UnitPointers[j])
+      {
+        UnitOffsets[i][j] = unit_offset;
+        unit_offset += unit_sizes[j];
+      }
+    }
+  }
+
+  offset = getSectionOffset(DatFile::Sections::Graphics);
+  GraphicOffsets.assign(dat.Graphics.size(), NO_OFFSET);
+  for (size_t i = 0; offset != NO_OFFSET && i < dat.Graphics.size(); ++i)
+  {
+    if (DatVersion < GV_AoE || dat.GraphicPointers[i])
+    {
+      GraphicOffsets[i] = offset;
+      offset += static_cast<uint32_t>(dat.Graphics[i].objectSize());
+    }
+  }
+
+  offset = getSectionOffset(DatFile::Sections::Techs);
+  TechOffsets.assign(dat.Techs.size(), NO_OFFSET);
+  for (size_t i = 0; offset != NO_OFFSET && i < dat.Techs.size(); ++i)
+  {
+    TechOffsets[i] = offset;
+    offset += static_cast<uint32_t>(dat.Techs[i].objectSize());
+  }
+}
+
+//------------------------------------------------------------------------------
+bool DatIndex::loadFor(const char *datFileName, GameVersion gv)
+{
+  try
+  {
+    uint32_t size;
+    uint32_t hash = hashFile(datFileName, &size);
+
+    load(getSidecarName(datFileName).c_str());
+
+    return hash == DatHash && size == DatSize && gv == LoadVersion;
+  }
+  catch (const std::ios_base::failure &)
+  {
+    return false;
+  }
+}
+
+//------------------------------------------------------------------------------
+void DatIndex::saveFor(DatFile &dat)
+{
+  build(dat);
+  saveAs(getSidecarName(dat.getFileName()).c_str());
+}
+
+//------------------------------------------------------------------------------
+std::string DatIndex::getSidecarName(const char *datFileName)
+{
+  return std::string(datFileName) + ".idx";
+}
+
+//------------------------------------------------------------------------------
+uint32_t DatIndex::hashFile(const char *fileName, uint32_t *size)
+{
+  std::ifstream file(fileName, std::ios::binary);
+
+  if (file.fail())
+    throw std::ios_base::failure("Can't read file: \"" + std::string(fileName) + "\"");
+
+  uLong crc = crc32(0L, Z_NULL, 0);
+  uint32_t total = 0;
+  char chunk[0x10000];
+
+  while (file)
+  {
+    file.read(chunk, sizeof(chunk));
+    std::streamsize got = file.gcount();
+
+    crc = crc32(crc, reinterpret_cast<const Bytef *>(chunk), static_cast<uInt>(got));
+    total += static_cast<uint32_t>(got);
+  }
+
+  if (size)
+    *size = total;
+
+  return static_cast<uint32_t>(crc);
+}
+
+//------------------------------------------------------------------------------
+uint32_t DatIndex::getSectionOffset(uint32_t section) const
+{
+  for (unsigned int i = 0; i < SectionOffsets.size(); ++i)
+  {
+    if (section == (1u << i))
+      return SectionOffsets[i];
+  }
+
+  return NO_OFFSET;
+}
+
+//------------------------------------------------------------------------------
+uint32_t DatIndex::getCivOffset(size_t civ) const
+{
+  return getOffset(CivOffsets, civ);
+}
+
+//------------------------------------------------------------------------------
+uint32_t DatIndex::getUnitOffset(size_t civ, size_t unit) const
+{
+  if (civ >= UnitOffsets.size())
+    return NO_OFFSET;
+
+  return getOffset(UnitOffsets[civ], unit);
+}
+
+//------------------------------------------------------------------------------
+uint32_t DatIndex::getGraphicOffset(size_t graphic) const
+{
+  return getOffset(GraphicOffsets, graphic);
+}
+
+//------------------------------------------------------------------------------
+uint32_t DatIndex::getTechOffset(size_t tech) const
+{
+  return getOffset(TechOffsets, tech);
+}
+
+//------------------------------------------------------------------------------
+uint32_t DatIndex::getOffset(const std::vector<uint32_t> &offsets, size_t i)
+{
+  return i < offsets.size() ? offsets[i] : NO_OFFSET;
+}
+
+//------------------------------------------------------------------------------
+void DatIndex::serializeObject(void)
+{
+  std::string magic = "GDIX";
+  serialize(magic, 4);
+
+  if (isOperation(OP_READ) && magic != "GDIX")
+    throw std::ios_base::failure("Not a dat index file");
+
+  serialize<uint32_t>(DatHash);
+  serialize<uint32_t>(DatSize);
+
+  int32_t load_version = LoadVersion;
+  int32_t version = DatVersion;
+  serialize<int32_t>(load_version);
+  serialize<int32_t>(version);
+  LoadVersion = static_cast<GameVersion>(load_version);
+  DatVersion = static_cast<GameVersion>(version);
+
+  uint32_t count;
+
+  serializeSize<uint32_t>(count, SectionOffsets.size());
+  serialize<uint32_t>(SectionOffsets, count);
+
+  serializeSize<uint32_t>(count, CivOffsets.size());
+  serialize<uint32_t>(CivOffsets, count);
+
+  if (isOperation(OP_READ))
+    UnitOffsets.resize(count);
+
+  for (std::vector<uint32_t> &units: UnitOffsets)
+  {
+    serializeSize<uint32_t>(count, units.size());
+    serialize<uint32_t>(units, count);
+  }
+
+  serializeSize<uint32_t>(count, GraphicOffsets.size());
+  serialize<uint32_t>(GraphicOffsets, count);
+
+  serializeSize<uint32_t>(count, TechOffsets.size());
+  serialize<uint32_t>(TechOffsets, count);
+}
+
+}
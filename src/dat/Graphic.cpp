@@ -61,8 +61,13 @@ unsigned short Graphic::getName2Size()
 
 void Graphic::serializeObject(void)
 {
-  GameVersion gv = getGameVersion();
+  serializeByFamily(*this);
+}
 
+//------------------------------------------------------------------------------
+template <class Versions>
+void Graphic::serializeVersioned(Versions gv)
+{
   if (gv > GV_LatestTap && gv < GV_C2 || gv < GV_Tapsa || gv > GV_LatestDE2)
   {
     serialize(Name, getNameSize());
@@ -93,9 +98,7 @@ void Graphic::serializeObject(void)
   }
   serialize<uint8_t>(IsLoaded); // Unused
   serialize<uint8_t>(OldColorFlag); // Unused
-  serialize<uint8_t>(Layer);
-  serialize<int16_t>(PlayerColor);
-  serialize<uint8_t>(TransparentSelection);
+  serializeFields(Layer, PlayerColor, TransparentSelection);
 
   serialize<int16_t>(Coordinates, 4);
 
@@ -106,17 +109,11 @@ void Graphic::serializeObject(void)
   {
     serialize<uint32_t>(WwiseSoundID);
   }
-  serialize<uint8_t>(AngleSoundsUsed);
-  serialize<int16_t>(FrameCount);
-  serialize<int16_t>(AngleCount);
-  serialize<float>(SpeedMultiplier);
+  serializeFields(AngleSoundsUsed, FrameCount, AngleCount, SpeedMultiplier);
   FrameDuration = FrameCount ? AnimationDuration / FrameCount : 0;
   serialize<float>(FrameDuration);
   AnimationDuration = FrameDuration * FrameCount;
-  serialize<float>(ReplayDelay);
-  serialize<uint8_t>(SequenceType);
-  serialize<int16_t>(ID);
-  serialize<uint8_t>(MirroringMode);
+  serializeFields(ReplayDelay, SequenceType, ID, MirroringMode);
 
   if (gv >= GV_AoKB) // 10.72
     serialize<uint8_t>(EditorFlag); // A sprite editor thing
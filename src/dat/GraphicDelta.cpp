@@ -39,13 +39,8 @@ void GraphicDelta::setGameVersion(GameVersion gv)
 
 void GraphicDelta::serializeObject(void)
 {
-  serialize<int16_t>(GraphicID);
-  serialize<int16_t>(Padding1);
-  serialize<int32_t>(SpritePtr);
-  serialize<int16_t>(OffsetX);
-  serialize<int16_t>(OffsetY);
-  serialize<int16_t>(DisplayAngle);
-  serialize<int16_t>(Padding2);
+  serializeFields(GraphicID, Padding1, SpritePtr, OffsetX, OffsetY,
+    DisplayAngle, Padding2);
 }
 
 }
@@ -43,25 +43,16 @@ void PlayerColour::serializeObject(void)
   if (getGameVersion() < GV_AoKE3)
   {
     serialize(Name, NAME_SIZE);
-    serialize<int16_t>(IdS16);
-    serialize<int16_t>(ResourceID);
-    serialize<uint8_t>(MinimapColorU8);
-    serialize<uint8_t>(Type);
+    serializeFields(IdS16, ResourceID, MinimapColorU8, Type);
 
     ID = IdS16;
     MinimapColour = MinimapColorU8;
   }
   else
   {
-    serialize<int32_t>(ID);
-    serialize<int32_t>(PlayerColorBase);
-    serialize<int32_t>(UnitOutlineColor);
-    serialize<int32_t>(UnitSelectionColor1);
-    serialize<int32_t>(UnitSelectionColor2);
-    serialize<int32_t>(MinimapColour);
-    serialize<int32_t>(MinimapColor2);
-    serialize<int32_t>(MinimapColor3);
-    serialize<int32_t>(StatisticsText);
+    serializeFields(ID, PlayerColorBase, UnitOutlineColor, UnitSelectionColor1,
+      UnitSelectionColor2, MinimapColour, MinimapColor2, MinimapColor3,
+      StatisticsText);
   }
 }
 
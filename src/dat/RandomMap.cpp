@@ -93,15 +93,9 @@ void MapInfo::serializeObject(void)
 
 // Yes. These are read and written twice.
 
-  serialize<int32_t>(BorderSouthWest);
-  serialize<int32_t>(BorderNorthWest);
-  serialize<int32_t>(BorderNorthEast);
-  serialize<int32_t>(BorderSouthEast);
-  serialize<int32_t>(BorderUsage);
-  serialize<int32_t>(WaterShape);
-  serialize<int32_t>(BaseTerrain);
-  serialize<int32_t>(LandCoverage);
-  serialize<int32_t>(UnusedID);
+  serializeFields(BorderSouthWest, BorderNorthWest, BorderNorthEast,
+    BorderSouthEast, BorderUsage, WaterShape, BaseTerrain, LandCoverage,
+    UnusedID);
 
   uint32_t count;
   serializeSize<uint32_t>(count, MapLands.size());
@@ -152,19 +146,9 @@ void MapLand::serializeObject(void)
 {
   serialize<int32_t>(LandID);
   serialize<uint32_t>(Terrain);//uint8_t
-  serialize<int32_t>(LandSpacing);
-  serialize<int32_t>(BaseSize);
-  serialize<uint8_t>(Zone);
-  serialize<uint8_t>(PlacementType);
-  serialize<int16_t>(Padding1);
-  serialize<int32_t>(BaseX);
-  serialize<int32_t>(BaseY);
-  serialize<uint8_t>(LandProportion);
-  serialize<uint8_t>(ByPlayerFlag);
-  serialize<int16_t>(Padding2);
-  serialize<int32_t>(StartAreaRadius);
-  serialize<int32_t>(TerrainEdgeFade);
-  serialize<int32_t>(Clumpiness);
+  serializeFields(LandSpacing, BaseSize, Zone, PlacementType, Padding1, BaseX,
+    BaseY, LandProportion, ByPlayerFlag, Padding2, StartAreaRadius,
+    TerrainEdgeFade, Clumpiness);
 }
 
 //------------------------------------------------------------------------------
@@ -186,12 +170,8 @@ void MapTerrain::setGameVersion(GameVersion gv)
 //------------------------------------------------------------------------------
 void MapTerrain::serializeObject(void)
 {
-  serialize<int32_t>(Proportion);
-  serialize<int32_t>(Terrain);
-  serialize<int32_t>(ClumpCount);
-  serialize<int32_t>(EdgeSpacing);
-  serialize<int32_t>(PlacementTerrain);
-  serialize<int32_t>(Clumpiness);
+  serializeFields(Proportion, Terrain, ClumpCount, EdgeSpacing,
+    PlacementTerrain, Clumpiness);
 }
 
 //------------------------------------------------------------------------------
@@ -213,19 +193,9 @@ void MapUnit::setGameVersion(GameVersion gv)
 //------------------------------------------------------------------------------
 void MapUnit::serializeObject(void)
 {
-  serialize<int32_t>(Unit);
-  serialize<int32_t>(HostTerrain);
-  serialize<uint8_t>(GroupPlacing);
-  serialize<uint8_t>(ScaleFlag);
-  serialize<int16_t>(Padding1);
-  serialize<int32_t>(ObjectsPerGroup);
-  serialize<int32_t>(Fluctuation);
-  serialize<int32_t>(GroupsPerPlayer);
-  serialize<int32_t>(GroupArea);
-  serialize<int32_t>(PlayerID);
-  serialize<int32_t>(SetPlaceForAllPlayers);
-  serialize<int32_t>(MinDistanceToPlayers);
-  serialize<int32_t>(MaxDistanceToPlayers);
+  serializeFields(Unit, HostTerrain, GroupPlacing, ScaleFlag, Padding1,
+    ObjectsPerGroup, Fluctuation, GroupsPerPlayer, GroupArea, PlayerID,
+    SetPlaceForAllPlayers, MinDistanceToPlayers, MaxDistanceToPlayers);
 }
 
 //------------------------------------------------------------------------------
@@ -247,12 +217,8 @@ void MapElevation::setGameVersion(GameVersion gv)
 //------------------------------------------------------------------------------
 void MapElevation::serializeObject(void)
 {
-  serialize<int32_t>(Proportion);
-  serialize<int32_t>(Terrain);
-  serialize<int32_t>(ClumpCount);
-  serialize<int32_t>(BaseTerrain);
-  serialize<int32_t>(BaseElevation);
-  serialize<int32_t>(TileSpacing);
+  serializeFields(Proportion, Terrain, ClumpCount, BaseTerrain, BaseElevation,
+    TileSpacing);
 }
 
 }
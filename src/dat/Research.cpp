@@ -81,16 +81,10 @@ void Tech::serializeObject(void)
       LanguageDLLDescription = LanguageDLLDescriptionU16;
     }
   }
-  serialize<int16_t>(ResearchTime);
-  serialize<int16_t>(EffectID);
-  serialize<int16_t>(Type);
-  serialize<int16_t>(IconID);
-  serialize<uint8_t>(ButtonID);
+  serializeFields(ResearchTime, EffectID, Type, IconID, ButtonID);
   if (gv >= GV_AoEB)
   {
-    serialize<int32_t>(LanguageDLLHelp);
-    serialize<int32_t>(LanguageDLLTechTree);
-    serialize<int32_t>(HotKey);
+    serializeFields(LanguageDLLHelp, LanguageDLLTechTree, HotKey);
   }
 
   if (gv > GV_LatestTap && gv < GV_C2 || gv < GV_Tapsa || gv > GV_LatestDE2)
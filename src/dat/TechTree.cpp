@@ -266,9 +266,7 @@ void UnitConnection::setGameVersion(GameVersion gv)
 //------------------------------------------------------------------------------
 void UnitConnection::serializeObject(void)
 {
-  serialize<int32_t>(ID);
-  serialize<uint8_t>(Status);
-  serialize<int32_t>(UpperBuilding);
+  serializeFields(ID, Status, UpperBuilding);
 
   serialize<ISerializable>(Common);
 
@@ -314,9 +312,7 @@ void ResearchConnection::setGameVersion(GameVersion gv)
 //------------------------------------------------------------------------------
 void ResearchConnection::serializeObject(void)
 {
-  serialize<int32_t>(ID);
-  serialize<uint8_t>(Status);
-  serialize<int32_t>(UpperBuilding);
+  serializeFields(ID, Status, UpperBuilding);
 
   uint8_t count;
   if (getGameVersion() < GV_AoKB)// < 10.84
@@ -42,11 +42,7 @@ void EffectCommand::setGameVersion(GameVersion gv)
 //------------------------------------------------------------------------------
 void EffectCommand::serializeObject(void)
 {
-  serialize<uint8_t>(Type);
-  serialize<int16_t>(A);
-  serialize<int16_t>(B);
-  serialize<int16_t>(C);
-  serialize<float>(D);
+  serializeFields(Type, A, B, C, D);
 }
 
 }
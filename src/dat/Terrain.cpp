@@ -99,9 +99,7 @@ void Terrain::serializeObject(void)
   {
     if (gv >= GV_T2 && gv < GV_C2 || gv >= GV_C8 && gv <= GV_LatestDE2)
     {
-      serialize<uint8_t>(IsWater);
-      serialize<uint8_t>(HideInEditor);
-      serialize<int32_t>(StringID);
+      serializeFields(IsWater, HideInEditor, StringID);
     }
     if (gv >= GV_T2 && gv < GV_C2)
     {
@@ -147,16 +145,8 @@ void Terrain::serializeObject(void)
   serialize<uint8_t>(PassableTerrain);
   serialize<uint8_t>(ImpassableTerrain);
 
-  serialize<uint8_t>(IsAnimated);
-  serialize<int16_t>(AnimationFrames);
-  serialize<int16_t>(PauseFames);
-  serialize<float>(Interval);
-  serialize<float>(PauseBetweenLoops);
-  serialize<int16_t>(Frame);
-  serialize<int16_t>(DrawFrame);
-  serialize<float>(AnimateLast);
-  serialize<uint8_t>(FrameChanged);
-  serialize<uint8_t>(Drawn);
+  serializeFields(IsAnimated, AnimationFrames, PauseFames, Interval,
+    PauseBetweenLoops, Frame, DrawFrame, AnimateLast, FrameChanged, Drawn);
 
   serializeSub<FrameData>(ElevationGraphics, TILE_TYPE_COUNT);
   serialize<int16_t>(TerrainToDraw);
@@ -89,11 +89,7 @@ void TerrainBlock::serializeObject(void)
   GameVersion gv = getGameVersion();
 
   serialize<uint32_t>(VirtualFunctionPtr);// __vfptr
-  serialize<uint32_t>(MapPointer);
-  serialize<int32_t>(MapWidth);
-  serialize<int32_t>(MapHeight);
-  serialize<int32_t>(WorldWidth);
-  serialize<int32_t>(WorldHeight);
+  serializeFields(MapPointer, MapWidth, MapHeight, WorldWidth, WorldHeight);
 
   serializeSub<TileSize>(TileSizes, SharedTerrain::TILE_TYPE_COUNT);
   if (gv >= GV_AoE)
@@ -122,10 +118,7 @@ void TerrainBlock::serializeObject(void)
 
   if (gv >= GV_AoKA)
   {
-    serialize<float>(MapMinX);
-    serialize<float>(MapMinY);
-    serialize<float>(MapMaxX);
-    serialize<float>(MapMaxY);
+    serializeFields(MapMinX, MapMinY, MapMaxX, MapMaxY);
     if (gv >= GV_AoK)
     {
       serialize<float>(MapMaxXplus1);
@@ -136,25 +129,13 @@ void TerrainBlock::serializeObject(void)
   serialize<int16_t>(TerrainsUsed2);
   if (gv < GV_AoEB)
     serialize<int16_t>(RemovedBlocksUsed);
-  serialize<int16_t>(BordersUsed);
-  serialize<int16_t>(MaxTerrain);
-  serialize<int16_t>(TileWidth);
-  serialize<int16_t>(TileHeight);
-  serialize<int16_t>(TileHalfHeight);
-  serialize<int16_t>(TileHalfWidth);
-  serialize<int16_t>(ElevHeight);
-  serialize<int16_t>(CurRow);
-  serialize<int16_t>(CurCol);
-  serialize<int16_t>(BlockBegRow);
-  serialize<int16_t>(BlockEndRow);
-  serialize<int16_t>(BlockBegCol);
-  serialize<int16_t>(BlockEndCol);
+  serializeFields(BordersUsed, MaxTerrain, TileWidth, TileHeight,
+    TileHalfHeight, TileHalfWidth, ElevHeight, CurRow, CurCol, BlockBegRow,
+    BlockEndRow, BlockBegCol, BlockEndCol);
 
   if (gv >= GV_AoKE3)
   {
-    serialize<uint32_t>(SearchMapPtr);
-    serialize<uint32_t>(SearchMapRowsPtr);
-    serialize<uint8_t>(AnyFrameChange);
+    serializeFields(SearchMapPtr, SearchMapRowsPtr, AnyFrameChange);
   }
   else
   {
@@ -62,16 +62,8 @@ void TerrainBorder::serializeObject(void)
   serialize<int32_t>(SoundID);
   serialize<uint8_t>(Colors, 3);
 
-  serialize<uint8_t>(IsAnimated);
-  serialize<int16_t>(AnimationFrames);
-  serialize<int16_t>(PauseFames);
-  serialize<float>(Interval);
-  serialize<float>(PauseBetweenLoops);
-  serialize<int16_t>(Frame);
-  serialize<int16_t>(DrawFrame);
-  serialize<float>(AnimateLast);
-  serialize<uint8_t>(FrameChanged);
-  serialize<uint8_t>(Drawn);
+  serializeFields(IsAnimated, AnimationFrames, PauseFames, Interval,
+    PauseBetweenLoops, Frame, DrawFrame, AnimateLast, FrameChanged, Drawn);
 
   for (auto &sub: Borders)
     serializeSub<FrameData>(sub, gv == GV_MIK ? 13 : 12);
@@ -41,9 +41,7 @@ void FrameData::setGameVersion(GameVersion gv)
 //------------------------------------------------------------------------------
 void FrameData::serializeObject(void)
 {
-  serialize<int16_t>(FrameCount);
-  serialize<int16_t>(AngleCount);
-  serialize<int16_t>(ShapeID);
+  serializeFields(FrameCount, AngleCount, ShapeID);
 }
 
 }
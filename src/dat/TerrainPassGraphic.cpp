@@ -47,9 +47,7 @@ void TerrainPassGraphic::serializeObject()
 {
   GameVersion gv = getGameVersion();
 
-  serialize<int32_t>(ExitTileSpriteID);
-  serialize<int32_t>(EnterTileSpriteID);
-  serialize<int32_t>(WalkTileSpriteID);
+  serializeFields(ExitTileSpriteID, EnterTileSpriteID, WalkTileSpriteID);
   if (gv < GV_SWGB && gv > GV_LatestTap)
   {
     serialize<int32_t>(WalkSpriteRate);
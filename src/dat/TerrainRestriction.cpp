@@ -25,13 +25,15 @@
 namespace genie
 {
 
-unsigned short TerrainRestriction::terrain_count_ = 0;
+//------------------------------------------------------------------------------
+TerrainRestriction::TerrainRestriction()
+{
+}
 
 //------------------------------------------------------------------------------
-TerrainRestriction::TerrainRestriction() :
-  PassableBuildableDmgMultiplier(terrain_count_),
-  TerrainPassGraphics(terrain_count_)
+TerrainRestriction::TerrainRestriction(unsigned short terrainCount)
 {
+  setTerrainCount(terrainCount);
 }
 
 //------------------------------------------------------------------------------
@@ -51,17 +53,44 @@ void TerrainRestriction::setGameVersion(GameVersion gv)
 void TerrainRestriction::setTerrainCount(unsigned short cnt)
 {
   terrain_count_ = cnt;
+
+  PassableBuildableDmgMultiplier.resize(cnt);
+  TerrainPassGraphics.resize(cnt);
+  updateGameVersion(TerrainPassGraphics);
+}
+
+//------------------------------------------------------------------------------
+unsigned short TerrainRestriction::serializedTerrainCount(void)
+{
+  int cnt = getContext().terrain_count;
+
+  if (cnt < 0)
+  {
+    if (terrain_count_ < 0)
+      throw std::ios_base::failure("TerrainRestriction: Terrain count not set");
+
+    return static_cast<unsigned short>(terrain_count_);
+  }
+
+  if (isOperation(OP_READ))
+    terrain_count_ = cnt;
+  else if (terrain_count_ < 0)
+    setTerrainCount(static_cast<unsigned short>(cnt));
+
+  return static_cast<unsigned short>(cnt);
 }
 
 //------------------------------------------------------------------------------
 void TerrainRestriction::serializeObject(void)
 {
-  serialize<float>(PassableBuildableDmgMultiplier, terrain_count_);
+  unsigned short terrain_count = serializedTerrainCount();
+
+  serialize<float>(PassableBuildableDmgMultiplier, terrain_count);
 
   GameVersion gv = getGameVersion();
   if (gv >= GV_AoKA || (gv >= GV_T4 && gv <= GV_LatestTap))
   {
-    serializeSub<TerrainPassGraphic>(TerrainPassGraphics, terrain_count_);
+    serializeSub<TerrainPassGraphic>(TerrainPassGraphics, terrain_count);
   }
 }
 
@@ -50,8 +50,13 @@ void Unit::setGameVersion(GameVersion gv)
 //------------------------------------------------------------------------------
 void Unit::serializeObject(void)
 {
-  GameVersion gv = getGameVersion();
+  serializeByFamily(*this);
+}
 
+//------------------------------------------------------------------------------
+template <class Versions>
+void Unit::serializeVersioned(Versions gv)
+{
   //Type 10+
   if (gv < GV_AoEB && isOperation(OP_WRITE)) Type /= 10;
   serialize<uint8_t>(Type); // 7 = 70 in AoE alphas etc
@@ -78,27 +83,16 @@ void Unit::serializeObject(void)
   }
   serialize<int16_t>(Class);
   serializePair<int16_t>(StandingGraphic, (gv >= GV_AoKB) ? false : true);
-  serialize<int16_t>(DyingGraphic);
-  serialize<int16_t>(UndeadGraphic);
-  serialize<uint8_t>(UndeadMode);
-  serialize<int16_t>(HitPoints);
-  serialize<float>(LineOfSight);
-  serialize<uint8_t>(GarrisonCapacity);
-  serialize<float>(CollisionSize.x);
-  serialize<float>(CollisionSize.y);
-  serialize<float>(CollisionSize.z);
-  serialize<int16_t>(TrainSound);
+  serializeFields(DyingGraphic, UndeadGraphic, UndeadMode, HitPoints,
+    LineOfSight, GarrisonCapacity, CollisionSize.x, CollisionSize.y,
+    CollisionSize.z, TrainSound);
   if (gv >= GV_AoKE3)
     serialize<int16_t>(DamageSound);
   serialize<int16_t>(DeadUnitID);
   if (gv >= GV_T6 && gv <= GV_LatestTap || gv >= GV_C7 && gv <= GV_LatestDE2)
     serialize<int16_t>(BloodUnitID);
-  serialize<uint8_t>(SortNumber);
-  serialize<uint8_t>(CanBeBuiltOn);
-  serialize<int16_t>(IconID);
-  serialize<uint8_t>(HideInEditor);
-  serialize<int16_t>(OldPortraitPict);
-  serialize<uint8_t>(Enabled);
+  serializeFields(SortNumber, CanBeBuiltOn, IconID, HideInEditor,
+    OldPortraitPict, Enabled);
 
   if (gv >= GV_AoK) // 11.48
     serialize<uint8_t>(Disabled);
@@ -107,28 +101,14 @@ void Unit::serializeObject(void)
     serializePair<int16_t>(PlacementSideTerrain);
   serializePair<int16_t>(PlacementTerrain); // Before AoE, this also contains side terrain.
   serializePair<float>(ClearanceSize);
-  serialize<uint8_t>(HillMode);
-  serialize<uint8_t>(FogVisibility);
-  serialize<int16_t>(TerrainRestriction);
-  serialize<uint8_t>(FlyMode);
-  serialize<int16_t>(ResourceCapacity);
-  serialize<float>(ResourceDecay);
-  serialize<uint8_t>(BlastDefenseLevel);
-  serialize<uint8_t>(CombatLevel);
-  serialize<uint8_t>(InteractionMode);
-  serialize<uint8_t>(MinimapMode);
-  serialize<uint8_t>(InterfaceKind);
-  serialize<float>(MultipleAttributeMode);
-  serialize<uint8_t>(MinimapColor);
+  serializeFields(HillMode, FogVisibility, TerrainRestriction, FlyMode,
+    ResourceCapacity, ResourceDecay, BlastDefenseLevel, CombatLevel,
+    InteractionMode, MinimapMode, InterfaceKind, MultipleAttributeMode,
+    MinimapColor);
   if (gv >= GV_AoEB) // 7.04
   {
-    serialize<int32_t>(LanguageDLLHelp);
-    serialize<int32_t>(LanguageDLLHotKeyText);
-    serialize<int32_t>(HotKey);
-    serialize<uint8_t>(Recyclable);
-    serialize<uint8_t>(EnableAutoGather);
-    serialize<uint8_t>(CreateDoppelgangerOnDeath);
-    serialize<uint8_t>(ResourceGatherGroup);
+    serializeFields(LanguageDLLHelp, LanguageDLLHotKeyText, HotKey, Recyclable,
+      EnableAutoGather, CreateDoppelgangerOnDeath, ResourceGatherGroup);
 
     if (gv >= GV_AoKE3) // 9.15
     {
@@ -139,9 +119,7 @@ void Unit::serializeObject(void)
         serialize<uint8_t>(ObstructionClass); // 9.56
         if (gv >= GV_TC) // 11.55
         {
-          serialize<uint8_t>(Trait);
-          serialize<uint8_t>(Civilization);
-          serialize<int16_t>(Nothing);
+          serializeFields(Trait, Civilization, Nothing);
         }
       }
     }
@@ -151,11 +129,8 @@ void Unit::serializeObject(void)
       serialize<uint8_t>(ObstructionClass);
     }
 
-    serialize<uint8_t>(SelectionEffect);
-    serialize<uint8_t>(EditorSelectionColour);
-    serialize<float>(OutlineSize.x);
-    serialize<float>(OutlineSize.y);
-    serialize<float>(OutlineSize.z);
+    serializeFields(SelectionEffect, EditorSelectionColour, OutlineSize.x,
+      OutlineSize.y, OutlineSize.z);
 
     if (gv >= GV_CK && gv <= GV_LatestDE2)
     {
@@ -177,10 +152,8 @@ void Unit::serializeObject(void)
   serialize<int16_t>(DyingSound);
   if (gv >= GV_C4 && gv <= GV_LatestDE2)
   {
-    serialize<uint32_t>(WwiseTrainSoundID);
-    serialize<uint32_t>(WwiseDamageSoundID);
-    serialize<uint32_t>(WwiseSelectionSoundID);
-    serialize<uint32_t>(WwiseDyingSoundID);
+    serializeFields(WwiseTrainSoundID, WwiseDamageSoundID,
+      WwiseSelectionSoundID, WwiseDyingSoundID);
   }
   serialize<uint8_t>(OldAttackReaction);
   serialize<uint8_t>(ConvertTerrain);
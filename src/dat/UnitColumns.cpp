@@ -0,0 +1,176 @@
+/*
+    geniedat - A library for reading and writing data files of genie
+               engine games.
+    Copyright (C) 2011 - 2013  Armin Preiml
+    Copyright (C) 2011 - 2021  Mikko "Tapsa" P
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "genie/dat/UnitColumns.h"
+
+namespace genie
+{
+
+//------------------------------------------------------------------------------
+UnitColumns::UnitColumns()
+{
+}
+
+//------------------------------------------------------------------------------
+UnitColumns::~UnitColumns()
+{
+}
+
+//------------------------------------------------------------------------------
+void UnitColumns::build(const DatFile &dat)
+{
+  clear();
+
+  // Count first, so every column is allocated only once.
+  size_t units = 0, costs = 0, attacks = 0, armours = 0;
+
+  for (const Civ &civ: dat.Civs)
+  {
+    for (size_t i = 0; i < civ.getUnitCount(); ++i)
+    {
+      if (!civ.UnitPointers[i])
+        continue;
+
+      const Unit &unit = civ.getUnit(i);
+
+      ++units;
+      costs += unit.Creatable.ResourceCosts.size();
+      attacks += unit.Type50.Attacks.size();
+      armours += unit.Type50.Armours.size();
+    }
+  }
+
+  CivID.reserve(units);
+  UnitID.reserve(units);
+  Type.reserve(units);
+  Class.reserve(units);
+  HitPoints.reserve(units);
+  LineOfSight.reserve(units);
+  Speed.reserve(units);
+  BaseArmor.reserve(units);
+  MaxRange.reserve(units);
+  ReloadTime.reserve(units);
+  DisplayedAttack.reserve(units);
+  TrainTime.reserve(units);
+
+  CostBegin.reserve(units + 1);
+  CostType.reserve(costs);
+  CostAmount.reserve(costs);
+  CostFlag.reserve(costs);
+
+  AttackBegin.reserve(units + 1);
+  AttackClass.reserve(attacks);
+  AttackAmount.reserve(attacks);
+
+  ArmourBegin.reserve(units + 1);
+  ArmourClass.reserve(armours);
+  ArmourAmount.reserve(armours);
+
+  for (size_t c = 0; c < dat.Civs.size(); ++c)
+  {
+    const Civ &civ = dat.Civs[c];
+
+    for (size_t i = 0; i < civ.getUnitCount(); ++i)
+    {
+      if (!civ.UnitPointers[i])
+        continue;
+
+      const Unit &unit = civ.getUnit(i);
+
+      CivID.push_back(static_cast<int16_t>(c));
+      UnitID.push_back(static_cast<int16_t>(i));
+
+      Type.push_back(unit.Type);
+      Class.push_back(unit.Class);
+      HitPoints.push_back(unit.HitPoints);
+      LineOfSight.push_back(unit.LineOfSight);
+      Speed.push_back(unit.Speed);
+      BaseArmor.push_back(unit.Type50.BaseArmor);
+      MaxRange.push_back(unit.Type50.MaxRange);
+      ReloadTime.push_back(unit.Type50.ReloadTime);
+      DisplayedAttack.push_back(unit.Type50.DisplayedAttack);
+      TrainTime.push_back(unit.Creatable.TrainTime);
+
+      CostBegin.push_back(static_cast<uint32_t>(CostType.size()));
+      for (const unit::Creatable::ResourceCost &cost: unit.Creatable.ResourceCosts)
+      {
+        CostType.push_back(cost.Type);
+        CostAmount.push_back(cost.Amount);
+        CostFlag.push_back(cost.Flag);
+      }
+
+      AttackBegin.push_back(static_cast<uint32_t>(AttackClass.size()));
+      for (const unit::AttackOrArmor &attack: unit.Type50.Attacks)
+      {
+        AttackClass.push_back(attack.Class);
+        AttackAmount.push_back(attack.Amount);
+      }
+
+      ArmourBegin.push_back(static_cast<uint32_t>(ArmourClass.size()));
+      for (const unit::AttackOrArmor &armour: unit.Type50.Armours)
+      {
+        ArmourClass.push_back(armour.Class);
+        ArmourAmount.push_back(armour.Amount);
+      }
+    }
+  }
+
+  CostBegin.push_back(static_cast<uint32_t>(CostType.size()));
+  AttackBegin.push_back(static_cast<uint32_t>(AttackClass.size()));
+  ArmourBegin.push_back(static_cast<uint32_t>(ArmourClass.size()));
+}
+
+//------------------------------------------------------------------------------
+size_t UnitColumns::size(void) const
+{
+  return CivID.size();
+}
+
+//------------------------------------------------------------------------------
+void UnitColumns::clear(void)
+{
+  CivID.clear();
+  UnitID.clear();
+  Type.clear();
+  Class.clear();
+  HitPoints.clear();
+  LineOfSight.clear();
+  Speed.clear();
+  BaseArmor.clear();
+  MaxRange.clear();
+  ReloadTime.clear();
+  DisplayedAttack.clear();
+  TrainTime.clear();
+
+  CostBegin.clear();
+  CostType.clear();
+  CostAmount.clear();
+  CostFlag.clear();
+
+  AttackBegin.clear();
+  AttackClass.clear();
+  AttackAmount.clear();
+
+  ArmourBegin.clear();
+  ArmourClass.clear();
+  ArmourAmount.clear();
+}
+
+}
@@ -44,35 +44,13 @@ void Task::serializeObject(void)
 {
   GameVersion gv = getGameVersion();
 
-  serialize<int16_t>(TaskType);
-  serialize<int16_t>(ID);
-  serialize<uint8_t>(IsDefault);
-  serialize<int16_t>(ActionType);
-  serialize<int16_t>(ClassID);
-  serialize<int16_t>(UnitID);
-  serialize<int16_t>(TerrainID);
-  serialize<int16_t>(ResourceIn);
-  serialize<int16_t>(ResourceMultiplier);
-  serialize<int16_t>(ResourceOut);
-  serialize<int16_t>(UnusedResource);
-  serialize<float>(WorkValue1);
-  serialize<float>(WorkValue2);
-  serialize<float>(WorkRange);
-  serialize<uint8_t>(AutoSearchTargets);
-  serialize<float>(SearchWaitTime);
-  serialize<uint8_t>(EnableTargeting);
-  serialize<uint8_t>(CombatLevelFlag);
-  serialize<int16_t>(GatherType);
-  serialize<int16_t>(WorkFlag2);
-  serialize<uint8_t>(TargetDiplomacy);
-  serialize<uint8_t>(CarryCheck);
-  serialize<uint8_t>(PickForConstruction);
-  serialize<int16_t>(MovingGraphicID);
-  serialize<int16_t>(ProceedingGraphicID);
-  serialize<int16_t>(WorkingGraphicID);
-  serialize<int16_t>(CarryingGraphicID);
-  serialize<int16_t>(ResourceGatheringSoundID);
-  serialize<int16_t>(ResourceDepositSoundID);
+  serializeFields(TaskType, ID, IsDefault, ActionType, ClassID, UnitID,
+    TerrainID, ResourceIn, ResourceMultiplier, ResourceOut, UnusedResource,
+    WorkValue1, WorkValue2, WorkRange, AutoSearchTargets, SearchWaitTime,
+    EnableTargeting, CombatLevelFlag, GatherType, WorkFlag2, TargetDiplomacy,
+    CarryCheck, PickForConstruction, MovingGraphicID, ProceedingGraphicID,
+    WorkingGraphicID, CarryingGraphicID, ResourceGatheringSoundID,
+    ResourceDepositSoundID);
   if (gv >= GV_C4 && gv <= GV_LatestDE2)
   {
     serialize<uint32_t>(WwiseResourceGatheringSoundID);
@@ -0,0 +1,66 @@
+/*
+    geniedat - A library for reading and writing data files of genie
+               engine games.
+    Copyright (C) 2011 - 2013  Armin Preiml
+    Copyright (C) 2011 - 2021  Mikko "Tapsa" P
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "genie/dat/UnitPool.h"
+
+namespace genie
+{
+
+//------------------------------------------------------------------------------
+UnitPool::UnitPool()
+{
+}
+
+//------------------------------------------------------------------------------
+UnitPool::~UnitPool()
+{
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<Unit> UnitPool::share(Unit &unit)
+{
+  ++shared_;
+
+  // Units are equal if they are written the same way.
+  WriteBuffer buffer(0x400);
+  unit.writeObject(buffer);
+
+  std::shared_ptr<Unit> &pooled =
+    units_[std::string(buffer.data.data(), buffer.size())];
+
+  if (!pooled)
+    pooled = std::make_shared<Unit>(std::move(unit));
+
+  return pooled;
+}
+
+//------------------------------------------------------------------------------
+size_t UnitPool::getUniqueCount(void) const
+{
+  return units_.size();
+}
+
+//------------------------------------------------------------------------------
+size_t UnitPool::getSharedCount(void) const
+{
+  return shared_;
+}
+
+}
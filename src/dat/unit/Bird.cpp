@@ -61,11 +61,14 @@ unsigned short Bird::getDropSiteCount(void)
 
 void Bird::serializeObject(void)
 {
-  GameVersion gv = getGameVersion();
+  serializeByFamily(*this);
+}
 
-  serialize<int16_t>(DefaultTaskID);
-  serialize<float>(SearchRadius);
-  serialize<float>(WorkRate);
+//------------------------------------------------------------------------------
+template <class Versions>
+void Bird::serializeVersioned(Versions gv)
+{
+  serializeFields(DefaultTaskID, SearchRadius, WorkRate);
 
   if (gv >= GV_C21 && gv <= GV_LatestDE2)
   {
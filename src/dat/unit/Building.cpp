@@ -44,8 +44,13 @@ void Building::setGameVersion(GameVersion gv)
 
 void Building::serializeObject(void)
 {
-  GameVersion gv = getGameVersion();
+  serializeByFamily(*this);
+}
 
+//------------------------------------------------------------------------------
+template <class Versions>
+void Building::serializeVersioned(Versions gv)
+{
   serialize<int16_t>(ConstructionGraphicID);
 
   if (gv >= GV_TC) // 11.53
@@ -69,11 +74,8 @@ void Building::serializeObject(void)
     }
   }
 
-  serialize<uint8_t>(AdjacentMode);
-  serialize<int16_t>(GraphicsAngle);
-  serialize<uint8_t>(DisappearsWhenBuilt);
-  serialize<int16_t>(StackUnitID);
-  serialize<int16_t>(FoundationTerrainID);
+  serializeFields(AdjacentMode, GraphicsAngle, DisappearsWhenBuilt, StackUnitID,
+    FoundationTerrainID);
   serialize<int16_t>(OldOverlayID); // No longer used
   serialize<int16_t>(TechID);
 
@@ -96,9 +98,7 @@ void Building::serializeObject(void)
       serialize<uint32_t>(WwiseTransformSoundID);
       serialize<uint32_t>(WwiseConstructionSoundID);
     }
-    serialize<uint8_t>(GarrisonType);
-    serialize<float>(GarrisonHealRate);
-    serialize<float>(GarrisonRepairRate);
+    serializeFields(GarrisonType, GarrisonHealRate, GarrisonRepairRate);
     {
       serialize<int16_t>(PileUnit); // 9.06
       // 9.06 - 9.25 -> 5 x 2 x int16_t
@@ -50,20 +50,21 @@ unsigned short Creatable::getResourceCostsSize()
 
 void Creatable::serializeObject(void)
 {
-  GameVersion gv = getGameVersion();
+  serializeByFamily(*this);
+}
 
+//------------------------------------------------------------------------------
+template <class Versions>
+void Creatable::serializeVersioned(Versions gv)
+{
   serializeSub<ResourceCost>(ResourceCosts, 3);
-  serialize<int16_t>(TrainTime);
-  serialize<int16_t>(TrainLocationID);
-  serialize<uint8_t>(ButtonID);
+  serializeFields(TrainTime, TrainLocationID, ButtonID);
 
   if (gv >= GV_AoEB) // 7.01
   {
     if (gv >= GV_AoKE3) // 9.07
     {
-      serialize<float>(RearAttackModifier);
-      serialize<float>(FlankAttackModifier);
-      serialize<uint8_t>(CreatableType);
+      serializeFields(RearAttackModifier, FlankAttackModifier, CreatableType);
 
       if (gv >= GV_AoKB)
       {
@@ -85,10 +86,7 @@ void Creatable::serializeObject(void)
                 serialize<int16_t>(IdleAttackGraphic);
               }
             }
-            serialize<float>(MaxCharge);
-            serialize<float>(RechargeRate);
-            serialize<int16_t>(ChargeEvent);
-            serialize<int16_t>(ChargeType);
+            serializeFields(MaxCharge, RechargeRate, ChargeEvent, ChargeType);
 
             if (gv >= GV_C19)
             {
@@ -99,19 +97,15 @@ void Creatable::serializeObject(void)
                 {
                   if (gv >= GV_C25)
                   {
-                    serialize<int32_t>(ChargeProjectileUnit);
-                    serialize<uint8_t>(AttackPriority);
-                    serialize<float>(InvulnerabilityLevel);
+                    serializeFields(ChargeProjectileUnit, AttackPriority,
+                      InvulnerabilityLevel);
                   }
-                  serialize<int16_t>(ButtonIconID);
-                  serialize<int32_t>(ButtonShortTooltipID);
-                  serialize<int32_t>(ButtonExtendedTooltipID);
-                  serialize<int16_t>(ButtonHotkeyAction);
+                  serializeFields(ButtonIconID, ButtonShortTooltipID,
+                    ButtonExtendedTooltipID, ButtonHotkeyAction);
                 }
               }
-              serialize<float>(MinConversionTimeMod);
-              serialize<float>(MaxConversionTimeMod);
-              serialize<float>(ConversionChanceMod);
+              serializeFields(MinConversionTimeMod, MaxConversionTimeMod,
+                ConversionChanceMod);
             }
           }
         }
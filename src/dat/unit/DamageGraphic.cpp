@@ -42,9 +42,7 @@ void DamageGraphic::setGameVersion(GameVersion gv)
 
 void DamageGraphic::serializeObject(void)
 {
-  serialize<int16_t>(GraphicID);
-  serialize<int16_t>(DamagePercent);
-  serialize<uint8_t>(ApplyMode);
+  serializeFields(GraphicID, DamagePercent, ApplyMode);
 }
 
 }
@@ -42,24 +42,20 @@ void DeadFish::setGameVersion(GameVersion gv)
 
 void DeadFish::serializeObject(void)
 {
-  GameVersion gv = getGameVersion();
+  serializeByFamily(*this);
+}
 
-  serialize<int16_t>(WalkingGraphic);
-  serialize<int16_t>(RunningGraphic);
-  serialize<float>(RotationSpeed);
-  serialize<uint8_t>(OldSizeClass);
-  serialize<int16_t>(TrackingUnit);
-  serialize<uint8_t>(TrackingUnitMode);
-  serialize<float>(TrackingUnitDensity);
-  serialize<uint8_t>(OldMoveAlgorithm);
+//------------------------------------------------------------------------------
+template <class Versions>
+void DeadFish::serializeVersioned(Versions gv)
+{
+  serializeFields(WalkingGraphic, RunningGraphic, RotationSpeed, OldSizeClass,
+    TrackingUnit, TrackingUnitMode, TrackingUnitDensity, OldMoveAlgorithm);
 
   if (gv >= GV_AoKB) // 10.28
   {
-    serialize<float>(TurnRadius);
-    serialize<float>(TurnRadiusSpeed);
-    serialize<float>(MaxYawPerSecondMoving);
-    serialize<float>(StationaryYawRevolutionTime);
-    serialize<float>(MaxYawPerSecondStationary);
+    serializeFields(TurnRadius, TurnRadiusSpeed, MaxYawPerSecondMoving,
+      StationaryYawRevolutionTime, MaxYawPerSecondStationary);
 
     if (gv <= GV_LatestDE2 && gv >= GV_C14)
     {
@@ -42,12 +42,8 @@ void Projectile::setGameVersion(GameVersion gv)
 
 void Projectile::serializeObject(void)
 {
-  serialize<uint8_t>(ProjectileType);
-  serialize<uint8_t>(SmartMode);
-  serialize<uint8_t>(HitMode);
-  serialize<uint8_t>(VanishMode);
-  serialize<uint8_t>(AreaEffectSpecials);
-  serialize<float>(ProjectileArc);
+  serializeFields(ProjectileType, SmartMode, HitMode, VanishMode,
+    AreaEffectSpecials, ProjectileArc);
 }
 
 }
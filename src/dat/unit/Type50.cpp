@@ -46,7 +46,13 @@ void Type50::setGameVersion(GameVersion gv)
 
 void Type50::serializeObject(void)
 {
-  GameVersion gv = getGameVersion();
+  serializeByFamily(*this);
+}
+
+//------------------------------------------------------------------------------
+template <class Versions>
+void Type50::serializeVersioned(Versions gv)
+{
   if (gv < GV_TC // 11.52
   && (gv > GV_LatestTap || gv < GV_T3))
   {
@@ -70,11 +76,8 @@ void Type50::serializeObject(void)
   {
     serialize<float>(BonusDamageResistance);
   }
-  serialize<float>(MaxRange);
-  serialize<float>(BlastWidth);
-  serialize<float>(ReloadTime);
-  serialize<int16_t>(ProjectileUnitID);
-  serialize<int16_t>(AccuracyPercent);
+  serializeFields(MaxRange, BlastWidth, ReloadTime, ProjectileUnitID,
+    AccuracyPercent);
   serialize<uint8_t>(BreakOffCombat); // Not used anymore
   serialize<int16_t>(FrameDelay);
   serialize<float>(GraphicDisplacement, 3);
@@ -87,10 +90,8 @@ void Type50::serializeObject(void)
   serialize<int16_t>(AttackGraphic);
   if (gv >= GV_AoEB) // 7.01
   {
-    serialize<int16_t>(DisplayedMeleeArmour);
-    serialize<int16_t>(DisplayedAttack);
-    serialize<float>(DisplayedRange);
-    serialize<float>(DisplayedReloadTime);
+    serializeFields(DisplayedMeleeArmour, DisplayedAttack, DisplayedRange,
+      DisplayedReloadTime);
     if (gv <= GV_LatestDE2 && gv >= GV_C20)
     {
       serialize<float>(BlastDamage);
@@ -100,9 +101,7 @@ void Type50::serializeObject(void)
         serialize<float>(FriendlyFireDamage);
         if (gv >= GV_C27)
         {
-          serialize<int16_t>(InterruptFrame);
-          serialize<float>(GarrisonFirepower);
-          serialize<int16_t>(AttackGraphic2);
+          serializeFields(InterruptFrame, GarrisonFirepower, AttackGraphic2);
         }
       }
     }
@@ -21,10 +21,9 @@
 
 #include <vector>
 
-#include <boost/interprocess/streams/vectorstream.hpp>
-#include <boost/iostreams/filtering_streambuf.hpp>
+#include <zlib.h>
+
 #include <boost/iostreams/filter/zlib.hpp>
-#include <boost/iostreams/device/back_inserter.hpp>
 #include <boost/iostreams/copy.hpp>
 
 using namespace boost;
@@ -33,7 +32,206 @@ using namespace boost::iostreams;
 namespace genie
 {
 
-typedef boost::interprocess::basic_vectorstream< std::vector<char> > v_stream;
+namespace
+{
+
+/// Size of the chunks (de)compressed at once.
+const size_t ZLIB_CHUNK_SIZE = 0x10000;
+
+//------------------------------------------------------------------------------
+/// Stream buffer inflating a raw deflate stream from source chunk by chunk.
+/// Only supports telling the current position.
+//
+class InflateBuffer : public std::streambuf
+{
+public:
+  InflateBuffer(std::istream &source, const zlib_params &params) :
+    source_(source), in_(ZLIB_CHUNK_SIZE), out_(ZLIB_CHUNK_SIZE)
+  {
+    int ret = inflateInit2(&strm_, params.window_bits);
+
+    if (ret != Z_OK)
+      fail(ret);
+
+    setg(out_.data(), out_.data(), out_.data());
+  }
+
+  virtual ~InflateBuffer()
+  {
+    inflateEnd(&strm_);
+  }
+
+protected:
+  int_type underflow() override
+  {
+    if (gptr() < egptr())
+      return traits_type::to_int_type(*gptr());
+
+    consumed_ += egptr() - eback();
+
+    strm_.next_out = reinterpret_cast<Bytef *>(out_.data());
+    strm_.avail_out = static_cast<uInt>(out_.size());
+
+    while (strm_.avail_out == out_.size() && !finished_)
+    {
+      if (strm_.avail_in == 0)
+      {
+        source_.read(in_.data(), in_.size());
+
+        strm_.next_in = reinterpret_cast<Bytef *>(in_.data());
+        strm_.avail_in = static_cast<uInt>(source_.gcount());
+
+        // Truncated stream, treat as end of data.
+        if (strm_.avail_in == 0)
+          break;
+      }
+
+      int ret = inflate(&strm_, Z_NO_FLUSH);
+
+      if (ret == Z_STREAM_END)
+        finished_ = true;
+      else if (ret != Z_OK && ret != Z_BUF_ERROR)
+        fail(ret);
+    }
+
+    setg(out_.data(), out_.data(),
+         out_.data() + (out_.size() - strm_.avail_out));
+
+    if (gptr() == egptr())
+      return traits_type::eof();
+
+    return traits_type::to_int_type(*gptr());
+  }
+
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                   std::ios_base::openmode which) override
+  {
+    if (off != 0 || dir != std::ios_base::cur || !(which & std::ios_base::in))
+      return pos_type(off_type(-1));
+
+    return pos_type(consumed_ + (gptr() - eback()));
+  }
+
+private:
+  void fail(int ret)
+  {
+    std::cerr << "Zlib decompression failed with error code: "
+              << ret << std::endl;
+    throw zlib_error(ret);
+  }
+
+  std::istream &source_;
+
+  z_stream strm_ = {};
+  bool finished_ = false;
+
+  std::vector<char> in_;
+  std::vector<char> out_;
+
+  /// Bytes handed out before the current chunk.
+  off_type consumed_ = 0;
+};
+
+//------------------------------------------------------------------------------
+/// Stream buffer deflating everything written to it into sink chunk by
+/// chunk. Only supports telling the current position.
+//
+class DeflateBuffer : public std::streambuf
+{
+public:
+  DeflateBuffer(std::ostream &sink, const zlib_params &params) :
+    sink_(sink), in_(ZLIB_CHUNK_SIZE), out_(ZLIB_CHUNK_SIZE)
+  {
+    int ret = deflateInit2(&strm_, params.level, params.method,
+                           params.window_bits, params.mem_level,
+                           params.strategy);
+
+    if (ret != Z_OK)
+      fail(ret);
+
+    setp(in_.data(), in_.data() + in_.size());
+  }
+
+  virtual ~DeflateBuffer()
+  {
+    deflateEnd(&strm_);
+  }
+
+  //----------------------------------------------------------------------------
+  /// Compresses remaining data and ends the deflate stream.
+  //
+  void finish(void)
+  {
+    deflateChunk(Z_FINISH);
+  }
+
+protected:
+  int_type overflow(int_type c) override
+  {
+    deflateChunk(Z_NO_FLUSH);
+
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+
+    return traits_type::not_eof(c);
+  }
+
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                   std::ios_base::openmode which) override
+  {
+    if (off != 0 || dir != std::ios_base::cur || !(which & std::ios_base::out))
+      return pos_type(off_type(-1));
+
+    return pos_type(consumed_ + (pptr() - pbase()));
+  }
+
+private:
+  void deflateChunk(int flush)
+  {
+    strm_.next_in = reinterpret_cast<Bytef *>(pbase());
+    strm_.avail_in = static_cast<uInt>(pptr() - pbase());
+
+    consumed_ += strm_.avail_in;
+
+    do
+    {
+      strm_.next_out = reinterpret_cast<Bytef *>(out_.data());
+      strm_.avail_out = static_cast<uInt>(out_.size());
+
+      int ret = deflate(&strm_, flush);
+
+      if (ret == Z_STREAM_ERROR)
+        fail(ret);
+
+      sink_.write(out_.data(), out_.size() - strm_.avail_out);
+    }
+    while (strm_.avail_out == 0);
+
+    setp(in_.data(), in_.data() + in_.size());
+  }
+
+  void fail(int ret)
+  {
+    std::cerr << "Zlib compression failed with error code: "
+              << ret << std::endl;
+    throw zlib_error(ret);
+  }
+
+  std::ostream &sink_;
+
+  z_stream strm_ = {};
+
+  std::vector<char> in_;
+  std::vector<char> out_;
+
+  /// Bytes compressed before the current chunk.
+  off_type consumed_ = 0;
+};
+
+}
 
 Compressor::Compressor()
 {
@@ -52,9 +250,22 @@ Compressor::~Compressor()
 //------------------------------------------------------------------------------
 void Compressor::beginCompression(void)
 {
+  if (passThrough_)
+    return;
+
   switch(obj_->getOperation())
   {
     case ISerializable::OP_READ:
+      buffer_ = obj_->getReadBuffer();
+
+      if (buffer_)
+      {
+        inflateBuffer();
+
+        obj_->setReadBuffer(inflatedBuffer_.get());
+        break;
+      }
+
       istream_ = obj_->getIStream();
 
       startDecompression();
@@ -77,6 +288,9 @@ void Compressor::beginCompression(void)
 //------------------------------------------------------------------------------
 void Compressor::endCompression(void)
 {
+  if (passThrough_)
+    return;
+
   switch(obj_->getOperation())
   {
     case ISerializable::OP_READ:
@@ -125,78 +339,171 @@ boost::iostreams::zlib_params Compressor::getZlibParams(void ) const
 //------------------------------------------------------------------------------
 void Compressor::startDecompression(void)
 {
-  try
-  {
-    filtering_istreambuf in;
+  zlibBuffer_ = std::make_shared<InflateBuffer>(*istream_, getZlibParams());
 
-    // register decompressor
-    in.push(zlib_decompressor(getZlibParams()));
+  uncompressedIstream_ = std::make_shared<std::istream>(zlibBuffer_.get());
 
-    in.push(*istream_);
+  // Let errors thrown by the buffer reach the caller.
+  uncompressedIstream_->exceptions(std::ios_base::badbit);
+}
 
-    // extract file to buffer
-    std::vector<char> file_buf;
-    back_insert_device< std::vector<char> > b_ins(file_buf);
+//------------------------------------------------------------------------------
+void Compressor::inflateBuffer(void)
+{
+  z_stream strm = {};
 
-    copy(in, b_ins);
+  int ret = inflateInit2(&strm, getZlibParams().window_bits);
 
-    uncompressedIstream_ = std::shared_ptr<std::istream>(new v_stream(file_buf));
-  }
-  catch ( const zlib_error &z_err)
+  if (ret != Z_OK)
   {
-    uncompressedIstream_.reset();
     std::cerr << "Zlib decompression failed with error code: "
-              <<  z_err.error() << std::endl;
-    throw z_err;
+              << ret << std::endl;
+    throw zlib_error(ret);
   }
+
+  strm.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(buffer_->pos));
+  strm.avail_in = static_cast<uInt>(buffer_->end - buffer_->pos);
+
+  // Genie archives usually deflate to a quarter of their size.
+  inflated_.resize(std::max<size_t>(4 * strm.avail_in, 0x10000));
+
+  while (true)
+  {
+    if (strm.total_out == inflated_.size())
+      inflated_.resize(2 * inflated_.size());
+
+    strm.next_out = reinterpret_cast<Bytef *>(inflated_.data() + strm.total_out);
+    strm.avail_out = static_cast<uInt>(inflated_.size() - strm.total_out);
+
+    ret = inflate(&strm, Z_NO_FLUSH);
+
+    if (ret == Z_STREAM_END || (ret == Z_BUF_ERROR && strm.avail_in == 0))
+      break;
+
+    if (ret != Z_OK && ret != Z_BUF_ERROR)
+    {
+      inflateEnd(&strm);
+      std::cerr << "Zlib decompression failed with error code: "
+                << ret << std::endl;
+      throw zlib_error(ret);
+    }
+  }
+
+  inflated_.resize(strm.total_out);
+  inflateEnd(&strm);
+
+  buffer_->pos = buffer_->end;
+
+  inflatedBuffer_ = std::make_shared<ReadBuffer>(inflated_.data(),
+    inflated_.data() + inflated_.size());
 }
 
 //------------------------------------------------------------------------------
 void Compressor::stopDecompression(void)
 {
+  if (buffer_)
+  {
+    obj_->setReadBuffer(buffer_);
+    buffer_ = 0;
+
+    inflatedBuffer_.reset();
+    std::vector<char>().swap(inflated_);
+    return;
+  }
+
+  if (istream_)
+    obj_->setIStream(*istream_);
+
   istream_ = 0;
 
   uncompressedIstream_.reset();
+  zlibBuffer_.reset();
 }
 
 //------------------------------------------------------------------------------
 void Compressor::startCompression(void)
 {
-  // create buffer
-  std::vector<char> file_buf;
+  writeBuffer_ = obj_->getWriteBuffer();
 
-  bufferedStream_ = std::shared_ptr<std::iostream>(new v_stream(file_buf));
+  if (writeBuffer_)
+  {
+    // Buffers are sized for the whole object, what is left is the size of
+    // the part to compress.
+    uncompressedBuffer_ = std::make_shared<WriteBuffer>(
+      writeBuffer_->end - writeBuffer_->pos);
+
+    obj_->setWriteBuffer(uncompressedBuffer_.get());
+    return;
+  }
 
   ostream_ = obj_->getOStream();
 
-  obj_->setOStream(*bufferedStream_);
+  zlibBuffer_ = std::make_shared<DeflateBuffer>(*ostream_, getZlibParams());
+
+  uncompressedOstream_ = std::make_shared<std::ostream>(zlibBuffer_.get());
+
+  // Let errors thrown by the buffer reach the caller.
+  uncompressedOstream_->exceptions(std::ios_base::badbit);
+
+  obj_->setOStream(*uncompressedOstream_);
 }
 
 //------------------------------------------------------------------------------
 void Compressor::stopCompression(void)
 {
-  try
+  if (writeBuffer_)
   {
-    filtering_ostreambuf out;
+    deflateBuffer();
+
+    obj_->setWriteBuffer(writeBuffer_);
+    writeBuffer_ = 0;
+
+    uncompressedBuffer_.reset();
+    return;
+  }
 
-    out.push(zlib_compressor(getZlibParams()));
+  static_cast<DeflateBuffer *>(zlibBuffer_.get())->finish();
 
-    out.push(*ostream_);
+  obj_->setOStream(*ostream_);
+  ostream_ = 0;
 
-    copy (*bufferedStream_, out);
+  uncompressedOstream_.reset();
+  zlibBuffer_.reset();
+}
 
-    obj_->setOStream(*ostream_);
-    ostream_ = 0;
+//------------------------------------------------------------------------------
+void Compressor::deflateBuffer(void)
+{
+  zlib_params params = getZlibParams();
+  z_stream strm = {};
 
-    bufferedStream_.reset();
+  int ret = deflateInit2(&strm, params.level, params.method,
+                         params.window_bits, params.mem_level,
+                         params.strategy);
 
+  if (ret == Z_OK)
+  {
+    uLong size = static_cast<uLong>(uncompressedBuffer_->size());
+
+    writeBuffer_->reserve(deflateBound(&strm, size));
+
+    strm.next_in = reinterpret_cast<Bytef *>(uncompressedBuffer_->data.data());
+    strm.avail_in = static_cast<uInt>(size);
+    strm.next_out = reinterpret_cast<Bytef *>(writeBuffer_->pos);
+    strm.avail_out = static_cast<uInt>(writeBuffer_->end - writeBuffer_->pos);
+
+    ret = deflate(&strm, Z_FINISH);
+
+    writeBuffer_->pos += strm.total_out;
+    deflateEnd(&strm);
   }
-  catch (const zlib_error &z_err)
+
+  if (ret != Z_STREAM_END)
   {
     std::cerr << "Zlib compression failed with error code: "
-              <<  z_err.error() << std::endl;
-    throw z_err;
+              << ret << std::endl;
+    throw zlib_error(ret);
   }
 }
 
-}
\ No newline at end of file
+}
@@ -20,12 +20,17 @@
 
 #include "genie/file/IFile.h"
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
 namespace genie
 {
 
 //------------------------------------------------------------------------------
 IFile::IFile()
 {
+  // Files like SlpFile read frames from their stream after loading.
+  keepState();
 }
 
 //------------------------------------------------------------------------------
@@ -82,6 +87,35 @@ void IFile::load(const char *fileName)
   }
 }
 
+//------------------------------------------------------------------------------
+void IFile::loadMapped(const char *fileName)
+{
+  using namespace boost::interprocess;
+
+  freelock();
+
+  fileName_ = std::string(fileName);
+
+  file_mapping file;
+  mapped_region region;
+
+  try
+  {
+    file = file_mapping(fileName, read_only);
+    region = mapped_region(file, read_only);
+  }
+  catch (interprocess_exception &)
+  {
+    throw std::ios_base::failure("Cant read file: \"" + fileName_ + "\"");
+  }
+
+  const char *data = static_cast<const char *>(region.get_address());
+  ReadBuffer buffer(data, data + region.get_size());
+
+  readObject(buffer);
+  loaded_ = true;
+}
+
 //------------------------------------------------------------------------------
 void IFile::save(void )
 {
@@ -110,6 +144,32 @@ void IFile::saveAs(const char *fileName)
   file.close();
 }
 
+//------------------------------------------------------------------------------
+void IFile::saveBuffered(const char *fileName)
+{
+  std::ofstream file;
+
+  file.open(fileName, std::ofstream::binary);
+
+  if (file.fail())
+  {
+    file.close();
+    throw std::ios_base::failure("Cant write to file: \"" +
+                                std::string(fileName) + "\"");
+  }
+
+  WriteBuffer buffer(objectSize());
+
+  writeObject(buffer);
+
+  file.write(buffer.data.data(), buffer.size());
+  file.close();
+
+  if (file.fail())
+    throw std::ios_base::failure("Cant write to file: \"" +
+                                std::string(fileName) + "\"");
+}
+
 
 //------------------------------------------------------------------------------
 void IFile::unload(void)
@@ -25,45 +25,177 @@
 namespace genie
 {
 
+//------------------------------------------------------------------------------
+void WriteBuffer::grow(size_t len)
+{
+  size_t used = size();
+
+  data.resize(std::max(2 * data.size(), used + len));
+
+  pos = data.data() + used;
+  end = data.data() + data.size();
+}
+
+//------------------------------------------------------------------------------
+/// Top level calls use the state the object keeps, or one of their own that
+/// is dropped afterwards. Subobjects borrow the state of the object they are
+/// part of for the time they are serialized.
+//
+class ISerializable::StateScope
+{
+public:
+  StateScope(ISerializable *obj, Operation op) :
+    obj_(obj), previous_(obj->state_), root_(true)
+  {
+    if (!obj_->own_state_)
+      obj_->state_ = &local_;
+
+    obj_->state_->operation = op;
+    obj_->state_->context = &context_;
+  }
+
+  StateScope(ISerializable *obj, State *state) :
+    obj_(obj), previous_(obj->state_), root_(false)
+  {
+    obj_->state_ = state;
+  }
+
+  ~StateScope()
+  {
+    if (root_)
+      obj_->state_->context = 0;
+
+    if (!root_ || !obj_->own_state_)
+      obj_->state_ = previous_;
+  }
+
+  State &state(void)
+  {
+    return *obj_->state_;
+  }
+
+private:
+  ISerializable *obj_;
+  State *previous_;
+  bool root_;
+
+  State local_;
+  SerializationContext context_;
+};
+
+//------------------------------------------------------------------------------
+ISerializable::ISerializable(const ISerializable &other) :
+  gameVersion_(other.gameVersion_)
+{
+  if (other.own_state_)
+    ownState() = *other.state_;
+}
+
+//------------------------------------------------------------------------------
+ISerializable &ISerializable::operator=(const ISerializable &other)
+{
+  gameVersion_ = other.gameVersion_;
+
+  if (other.own_state_ && this != &other)
+    ownState() = *other.state_;
+
+  return *this;
+}
+
+//------------------------------------------------------------------------------
+ISerializable::~ISerializable()
+{
+  if (own_state_)
+    delete state_;
+}
+
+//------------------------------------------------------------------------------
+ISerializable::State &ISerializable::ownState(void)
+{
+  if (!state_)
+  {
+    state_ = new State;
+    own_state_ = true;
+  }
+
+  return *state_;
+}
+
 //------------------------------------------------------------------------------
 void ISerializable::readObject(std::istream &istr)
 {
-  setOperation(OP_READ);
-  istr_ = &istr;
+  StateScope scope(this, OP_READ);
+  State &state = scope.state();
 
-  istr_->seekg(init_read_pos_);
+  state.istr = &istr;
+  state.ibuf = 0;
+
+  state.istr->seekg(state.init_read_pos);
 
   serializeObject();
+}
+
+//------------------------------------------------------------------------------
+void ISerializable::readObject(ReadBuffer &buffer)
+{
+  StateScope scope(this, OP_READ);
+  State &state = scope.state();
 
+  state.ibuf = &buffer;
+  state.ibuf->pos = std::min(state.ibuf->begin +
+    std::streamoff(state.init_read_pos), state.ibuf->end);
+
+  serializeObject();
+
+  state.ibuf = 0;
 }
 
 //------------------------------------------------------------------------------
 void ISerializable::writeObject(std::ostream &ostr)
 {
-  setOperation(OP_WRITE);
-  ostr_ = &ostr;
+  StateScope scope(this, OP_WRITE);
+  State &state = scope.state();
+
+  state.ostr = &ostr;
+  state.obuf = 0;
+
   serializeObject();
+}
+
+//------------------------------------------------------------------------------
+void ISerializable::writeObject(WriteBuffer &buffer)
+{
+  StateScope scope(this, OP_WRITE);
+  State &state = scope.state();
 
+  state.obuf = &buffer;
+
+  serializeObject();
+
+  state.obuf = 0;
 }
 
 //------------------------------------------------------------------------------
 size_t ISerializable::objectSize(void)
 {
-  size_ = 0;
+  StateScope scope(this, OP_CALC_SIZE);
+
+  scope.state().size = 0;
 
-  setOperation(OP_CALC_SIZE);
   serializeObject();
 
-  return size_;
+  return scope.state().size;
 }
 
 //------------------------------------------------------------------------------
 void ISerializable::serializeSubObject(ISerializable * const other)
 {
-  istr_ = other->istr_;
-  ostr_ = other->ostr_;
-  operation_ = other->operation_;
+  StateScope scope(this, other->state_);
+
   setGameVersion(other->gameVersion_);
+
+  // Sizes are summed up in the shared state, subobjects are visited only
+  // once.
   serializeObject();
 }
 
@@ -87,7 +219,12 @@ size_t ISerializable::strnlen(const char *str, size_t maxLen)
 std::streampos ISerializable::tellg(void) const
 {
   if (isOperation(OP_READ))
-    return istr_->tellg();
+  {
+    if (state_->ibuf)
+      return state_->ibuf->pos - state_->ibuf->begin;
+
+    return state_->istr->tellg();
+  }
 
   return 0;
 }
@@ -95,20 +232,13 @@ std::streampos ISerializable::tellg(void) const
 //------------------------------------------------------------------------------
 std::string ISerializable::readString (size_t len)
 {
-  if (len > 0 && !istr_->eof())
+  if (len > 0 && (state_->ibuf ? state_->ibuf->pos != state_->ibuf->end : !state_->istr->eof()))
   {
-    char *buf = 0;
-    serialize<char>(&buf, len);
-
-    size_t tmp_len = ISerializable::strnlen(buf, len);
-
-    if (tmp_len < len)
-      len = tmp_len;
-
-    std::string ret(buf, len);
-    delete [] buf;
+    // Read only, bytes missing at the end of the data are zero.
+    std::vector<char> buf(len);
+    readElements(buf, std::true_type());
 
-    return ret;
+    return std::string(buf.data(), ISerializable::strnlen(buf.data(), len));
   }
 
   return "";
@@ -124,7 +254,7 @@ void ISerializable::writeString(std::string str, size_t len)
   for (size_t i = str.size(); i < len; i++)
     buf[i] = 0; // fill up with 0
 
-  ostr_->write(buf, len);
+  writeBytes(buf, len);
 
   delete [] buf;
 }
@@ -19,18 +19,29 @@
 
 #include "genie/resource/DrsFile.h"
 
+#include <algorithm>
+#include <cstring>
+#include <iterator>
 #include <string>
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
 #include "genie/util/Logger.h"
 #include "genie/file/ISerializable.h"
 
-//#include <file/BinaFile.h>
-
 namespace genie
 {
 
 Logger& DrsFile::log = Logger::getLogger("freeaoe.DrsFile");
 
+//------------------------------------------------------------------------------
+struct DrsFile::Mapping
+{
+  boost::interprocess::file_mapping file;
+  boost::interprocess::mapped_region region;
+};
+
 //------------------------------------------------------------------------------
 DrsFile::DrsFile()
 {
@@ -42,66 +53,122 @@ DrsFile::~DrsFile()
 }
 
 //------------------------------------------------------------------------------
-SlpFilePtr DrsFile::getSlpFile(uint32_t id)
+void DrsFile::load(const char *fileName)
 {
-  auto i = slp_map_.find(id);
+  using namespace boost::interprocess;
 
-  if (i != slp_map_.end())
+  std::unique_ptr<Mapping> mapping(new Mapping());
+
+  try
   {
-#ifndef NDEBUG
-    log.debug("Loading SLP file [%u]", id);
-#endif
-    i->second->readObject(*getIStream());
-    return i->second;
+    mapping->file = file_mapping(fileName, read_only);
+    mapping->region = mapped_region(mapping->file, read_only);
   }
-  else
+  catch (interprocess_exception &)
+  {
+    throw std::ios_base::failure("Cant read file: \"" +
+                                 std::string(fileName) + "\"");
+  }
+
+  freelock();
+  setFileName(fileName);
+
+  mapping_ = std::move(mapping);
+  data_ = static_cast<const uint8_t *>(mapping_->region.get_address());
+  data_size_ = mapping_->region.get_size();
+
+  // Tables are parsed straight from the mapping, no stream is opened.
+  const char *begin = reinterpret_cast<const char *>(data_);
+  ReadBuffer buffer(begin, begin + data_size_);
+  readObject(buffer);
+}
+
+//------------------------------------------------------------------------------
+SlpFilePtr DrsFile::getSlpFile(uint32_t id)
+{
+  DrsSpan data = getSlpData(id);
+
+  if (data.empty())
   {
     log.warn("No slp file with id [%u] found!", id);
     return SlpFilePtr();
   }
+
+  SlpSlot *slot;
+  {
+    std::lock_guard<std::mutex> lock(slp_map_mutex_);
+    // Map nodes stay put, so the slot outlives the lock.
+    slot = &slp_map_[id];
+  }
+
+  std::lock_guard<std::mutex> lock(slot->mutex);
+
+  if (!slot->slp)
+  {
+    char *begin = reinterpret_cast<char *>(const_cast<uint8_t *>(data.begin()));
+    slot->stream.reset(new IMemoryStream(begin, begin + data.size));
+    slot->slp.reset(new SlpFile());
+  }
+
+  if (!slot->slp->isLoaded())
+  {
+#ifndef NDEBUG
+    log.debug("Loading SLP file [%u]", id);
+#endif
+    slot->slp->setLazyLoading(lazy_slps_ || sprite_cache_);
+    slot->slp->setDecodeThreadCount(slp_decode_threads_);
+    slot->slp->setSpriteCache(sprite_cache_);
+    slot->slp->readObject(*slot->stream);
+  }
+
+  return slot->slp;
 }
 
 //------------------------------------------------------------------------------
 PalFilePtr DrsFile::getPalFile(uint32_t id)
 {
-  auto i = bina_map_.find(id);
+  DrsSpan data = getBinaryData(id);
 
-  if (i != bina_map_.end())
-  {
-    return i->second->readPalFile(getIStream());
-  }
-  else
+  if (data.empty())
   {
     log.warn("No bina file with id [%u] found!", id);
     return PalFilePtr();
   }
+
+  std::lock_guard<std::mutex> lock(pal_map_mutex_);
+
+  PalFilePtr &pal = pal_map_[id];
+
+  if (!pal)
+  {
+    char *begin = reinterpret_cast<char *>(const_cast<uint8_t *>(data.begin()));
+    IMemoryStream stream(begin, begin + data.size);
+
+    PalFilePtr parsed(new PalFile());
+    parsed->readObject(stream);
+    pal = parsed;
+  }
+
+  return pal;
 }
 
 //------------------------------------------------------------------------------
-unsigned char* DrsFile::getWavPtr(uint32_t id)
+const unsigned char* DrsFile::getWavPtr(uint32_t id)
 {
-  auto i = wav_offsets_.find(id);
+  DrsSpan data = getWavData(id);
 
-  if (i != wav_offsets_.end())
+  if (!data.empty())
   {
-    wav_file_.clear();
-    getIStream()->seekg(std::streampos(i->second));
 #ifndef NDEBUG
-    uint32_t type = read<uint32_t>();
-#else // Avoid -Wunused-value
-    read<uint32_t>();
-#endif
-    uint32_t size = read<uint32_t>();
-#ifndef NDEBUG
-    log.debug("WAV [%u], type [%X], size [%u]", id, type, size);
-#endif
-    getIStream()->seekg(std::streampos(i->second));
-    wav_file_.resize(size + 8);
-    for (auto &pos: wav_file_)
+    if (data.size >= 8)
     {
-      pos = read<uint8_t>();
+      uint32_t type, size;
+      memcpy(&type, data.data, sizeof(type));
+      memcpy(&size, data.data + 4, sizeof(size));
+      log.debug("WAV [%u], type [%X], size [%u]", id, type, size);
     }
-    return wav_file_.data();
+#endif
+    return data.data;
   }
   else
   {
@@ -110,6 +177,53 @@ unsigned char* DrsFile::getWavPtr(uint32_t id)
   }
 }
 
+//------------------------------------------------------------------------------
+DrsSpan DrsFile::getSlpData(uint32_t id) const
+{
+  return getData(slp_index_, id);
+}
+
+//------------------------------------------------------------------------------
+DrsSpan DrsFile::getBinaryData(uint32_t id) const
+{
+  return getData(bina_index_, id);
+}
+
+//------------------------------------------------------------------------------
+DrsSpan DrsFile::getWavData(uint32_t id) const
+{
+  return getData(wav_index_, id);
+}
+
+//------------------------------------------------------------------------------
+const DrsEntry *DrsFile::findEntry(const std::vector<DrsEntry> &index,
+                                   uint32_t id)
+{
+  // Later entries win over earlier ones with the same id.
+  auto i = std::upper_bound(index.begin(), index.end(), id,
+    [](uint32_t value, const DrsEntry &entry) { return value < entry.id; });
+
+  if (i == index.begin() || (i - 1)->id != id)
+    return nullptr;
+
+  return &*(i - 1);
+}
+
+//------------------------------------------------------------------------------
+DrsSpan DrsFile::getData(const std::vector<DrsEntry> &index, uint32_t id) const
+{
+  DrsSpan span;
+  const DrsEntry *entry = findEntry(index, id);
+
+  if (entry && entry->offset < data_size_)
+  {
+    span.data = data_ + entry->offset;
+    span.size = std::min<size_t>(entry->length, data_size_ - entry->offset);
+  }
+
+  return span;
+}
+
 //------------------------------------------------------------------------------
 void DrsFile::serializeObject(void)
 {
@@ -175,29 +289,48 @@ void DrsFile::loadHeader()
       {
         uint32_t id = read<uint32_t>();
         uint32_t pos = read<uint32_t>();
-        /*uint32_t len =*/ read<uint32_t>();
+        uint32_t len = read<uint32_t>();
 
         if (table_types_[i].compare(getSlpTableHeader()) == 0)
         {
-          SlpFilePtr slp(new SlpFile());
-          slp->setInitialReadPosition(pos);
-
-          slp_map_[id] = slp;
+          slp_index_.push_back({id, pos, len});
         }
         else if (table_types_[i].compare(getBinaryTableHeader()) == 0)
         {
-          BinaFilePtr bina(new BinaFile());
-          bina->setInitialReadPosition(pos);
-
-          bina_map_[id] = bina;
+          bina_index_.push_back({id, pos, len});
         }
         else if (table_types_[i].compare(getSoundTableHeader()) == 0)
         {
-          wav_offsets_[id] = pos;
+          wav_index_.push_back({id, pos, len});
         }
       }
     }
 
+    auto byId = [](const DrsEntry &a, const DrsEntry &b) { return a.id < b.id; };
+    std::stable_sort(slp_index_.begin(), slp_index_.end(), byId);
+    std::stable_sort(bina_index_.begin(), bina_index_.end(), byId);
+    std::stable_sort(wav_index_.begin(), wav_index_.end(), byId);
+
+    // Not loaded through load(const char *), keep a copy of the data so
+    // resources can still be handed out as spans. Streams are only read
+    // here, when there is no mapping.
+    if (!data_)
+    {
+      if (ReadBuffer *buffer = getReadBuffer())
+      {
+        file_data_.assign(buffer->begin, buffer->end);
+      }
+      else
+      {
+        std::istream *istr = getIStream();
+        istr->clear();
+        istr->seekg(0);
+        file_data_.assign(std::istreambuf_iterator<char>(*istr), {});
+      }
+      data_ = file_data_.data();
+      data_size_ = file_data_.size();
+    }
+
     header_loaded_ = true;
   }
 }
@@ -19,12 +19,17 @@
 
 #include "genie/resource/SlpFile.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <mutex>
 #include <stdexcept>
 #include <chrono>
 
 #include "genie/resource/SlpFrame.h"
 #include "genie/resource/PalFile.h"
+#include "genie/resource/SpriteCache.h"
+#include "genie/util/WorkerPool.h"
 
 #include "lz4hc.h"
 
@@ -33,6 +38,14 @@ namespace genie
 
 Logger& SlpFile::log = Logger::getLogger("genie.SlpFile");
 
+namespace
+{
+
+/// Size of the file header and of each frame header.
+const std::streamoff SLP_HEADER_SIZE = 32;
+
+}
+
 //------------------------------------------------------------------------------
 SlpFile::SlpFile() : IFile()
 {
@@ -41,6 +54,8 @@ SlpFile::SlpFile() : IFile()
 //------------------------------------------------------------------------------
 SlpFile::~SlpFile()
 {
+  if (cache_)
+    cache_->remove(this);
 }
 
 //------------------------------------------------------------------------------
@@ -59,88 +74,224 @@ void SlpFile::serializeObject(void)
 //------------------------------------------------------------------------------
 void SlpFile::loadFile()
 {
-  version = readString(4);
-  if (version[3] != 'P')//4.2P
+  loadData();
+
+  if (!lazy_)
   {
-    num_frames_ = read<uint16_t>();
-    properties_ = read<uint16_t>();
-    if (version[0] == '4')
-    {
-      read<uint64_t>();
-      uint32_t main_offset = read<uint32_t>();
-      assert(main_offset == 32);
-      shadow_offset_ = read<uint32_t>();
-      read<uint64_t>();
-    }
-    else
-    {
-      comment = readString(24);
-    }
+    decodeFrames();
+
+    std::vector<char>().swap(data_);
+    decoded_.clear();
+  }
+}
+
+//------------------------------------------------------------------------------
+void SlpFile::readHeader(void)
+{
+  num_frames_ = read<uint16_t>();
+  properties_ = read<uint16_t>();
+  if (version[0] == '4')
+  {
+    read<uint64_t>();
+    uint32_t main_offset = read<uint32_t>();
+    assert(main_offset == 32);
+    shadow_offset_ = read<uint32_t>();
+    read<uint64_t>();
   }
   else
   {
-    // Decompress rest of the file
-    int32_t original_size = read<int32_t>();
-    int32_t unpack_count;
-    std::vector<uint8_t> slp_data(original_size);
-    char *slp_data_ptr = reinterpret_cast<char *>(slp_data.data());
-    // There's probably better way to do this.
-    {
-      std::vector<uint8_t> input(std::istreambuf_iterator<char>(*getIStream()), {});
-      int32_t size = static_cast<int32_t>(input.size());
-      unpack_count = LZ4_decompress_safe(reinterpret_cast<const char *>(input.data()),
-        slp_data_ptr, size, original_size);
-    }
-    // Set the stream
+    comment = readString(24);
+  }
+}
+
+//------------------------------------------------------------------------------
+void SlpFile::readFrameHeaders(void)
+{
+  frames_.resize(num_frames_);
+
+  for (uint16_t i = 0; i < num_frames_; ++i)
+  {
+    frames_[i] = readFrameHeader(i);
+  }
+}
+
+//------------------------------------------------------------------------------
+SlpFramePtr SlpFile::readFrameHeader(uint16_t frame) const
+{
+  IMemoryStream slp_stream(const_cast<char *>(data_.data()),
+    const_cast<char *>(data_.data()) + data_.size());
+
+  SlpFramePtr header(new SlpFrame());
+  header->setLoadParams(slp_stream);
+
+  slp_stream.seekg(SLP_HEADER_SIZE * (frame + 1));
+  header->serializeHeader();
+
+  if (shadow_offset_ != 0)
+  {
+    slp_stream.seekg(shadow_offset_ + SLP_HEADER_SIZE * frame);
+    header->serializeShadowHeader();
+  }
+
+  return header;
+}
+
+//------------------------------------------------------------------------------
+void SlpFile::loadData(void)
+{
+  std::istream *istr = getIStream();
+
+  if (data_size_)
+  {
+    data_.resize(data_size_);
+    istr->read(data_.data(), data_size_);
+    data_.resize(static_cast<size_t>(istr->gcount()));
+  }
+  else
+  {
+    data_.assign(std::istreambuf_iterator<char>(*istr), {});
+  }
+
+  // 4.2P: version and original size followed by lz4 compressed slp
+  if (data_.size() >= 8 && data_[3] == 'P')
+  {
+    int32_t original_size;
+    memcpy(&original_size, data_.data() + 4, sizeof(original_size));
+
+    std::vector<char> slp_data(std::max(original_size, 0));
+    int32_t unpack_count = LZ4_decompress_safe(data_.data() + 8,
+      slp_data.data(), static_cast<int32_t>(data_.size() - 8), original_size);
+
     if (unpack_count == original_size)
-    {
-      IMemoryStream slp_stream(slp_data_ptr, slp_data_ptr + original_size);
-      setIStream(slp_stream);
-      return loadFile();
-    }
+      data_.swap(slp_data);
     else
-    {
-      num_frames_ = 0;
-    }
+      data_.clear();
   }
 
-  frames_.resize(num_frames_);
+  IMemoryStream slp_stream(data_.data(), data_.data() + data_.size());
+  setIStream(slp_stream);
+
+  version = readString(4);
+  if (version.size() == 4)
+  {
+    readHeader();
+  }
+  else
+  {
+    num_frames_ = 0;
+  }
+
+  readFrameHeaders();
+
+  setIStream(*istr);
+
+  decoded_.assign(num_frames_, false);
+  frame_memory_.assign(num_frames_, 0);
   size_in_memory_ = sizeof(SlpFile);
 
-  // Load frame headers
-  for (uint16_t i = 0; i < num_frames_; ++i)
+  loaded_ = true;
+}
+
+//------------------------------------------------------------------------------
+void SlpFile::decodeFrames(void)
+{
+  unsigned int thread_count = WorkerPool::resolveThreadCount(decode_threads_);
+
+  // Threads left over when there are fewer frames decode rows of tall frames.
+  unsigned int row_threads = 1;
+  if (num_frames_ && thread_count > num_frames_)
   {
-    frames_[i] = SlpFramePtr(new SlpFrame());
-    frames_[i]->setLoadParams(*getIStream());
-    frames_[i]->serializeHeader();
-    frames_[i]->setSlpFilePos(getInitialReadPosition());
+    row_threads = thread_count / num_frames_;
+    thread_count = num_frames_;
   }
 
-  // Load frame content
-  for (uint16_t i = 0; i < num_frames_; ++i)
+  std::vector<size_t> frame_sizes(num_frames_, 0);
+
+  WorkerPool::getGlobalPool().run(num_frames_, thread_count, [&](size_t i) {
+    frame_sizes[i] = decodeFrameData(static_cast<uint16_t>(i), row_threads);
+  });
+
+  for (size_t frame_size : frame_sizes)
+  {
+    size_in_memory_ += frame_size;
+  }
+}
+
+//------------------------------------------------------------------------------
+size_t SlpFile::decodeFrame(uint16_t frame)
+{
+  size_t frame_size;
+
+  try
   {
-    size_in_memory_ += frames_[i]->load(properties_);
+    frame_size = decodeFrameData(frame);
   }
+  catch (...)
+  {
+    // Don't leave a half decoded frame behind for the next attempt.
+    frames_[frame] = readFrameHeader(frame);
+    throw;
+  }
+
+  size_in_memory_ += frame_size;
+  frame_memory_[frame] = frame_size;
+  decoded_[frame] = true;
+
+  return frame_size;
+}
+
+//------------------------------------------------------------------------------
+size_t SlpFile::decodeFrameData(uint16_t frame, unsigned int row_threads)
+{
+  const uint8_t *slp_data = reinterpret_cast<const uint8_t *>(data_.data());
+
+  size_t frame_size = frames_[frame]->load(slp_data, data_.size(),
+    properties_, row_threads);
 
-  // Load shadow layer
   if (shadow_offset_ != 0)
   {
-    getIStream()->seekg(getInitialReadPosition() + std::streampos(shadow_offset_));
+    frame_size += frames_[frame]->loadSpecialShadow(slp_data, data_.size());
+  }
 
-    // Load shadow headers
-    for (uint16_t i = 0; i < num_frames_; ++i)
-    {
-      frames_[i]->serializeShadowHeader();
-    }
+  return frame_size;
+}
 
-    // Load shadow content
-    for (uint16_t i = 0; i < num_frames_; ++i)
-    {
-      size_in_memory_ += frames_[i]->loadSpecialShadow();
-    }
+//------------------------------------------------------------------------------
+void SlpFile::setDecodeThreadCount(unsigned int count)
+{
+  decode_threads_ = count;
+}
+
+//------------------------------------------------------------------------------
+void SlpFile::setSpriteCache(SpriteCache *cache)
+{
+  if (cache_ && cache_ != cache)
+    cache_->remove(this);
+
+  cache_ = cache;
+}
+
+//------------------------------------------------------------------------------
+size_t SlpFile::evictFrame(uint16_t frame)
+{
+  std::lock_guard<std::mutex> lock(decode_mutex_);
+
+  // Frames set by the user have no memory recorded and can't be decoded.
+  if (!lazy_ || frame >= decoded_.size() || !decoded_[frame] ||
+      frame_memory_[frame] == 0)
+  {
+    return 0;
   }
 
-  loaded_ = true;
+  // Callers holding the decoded frame keep it, only the file lets go of it.
+  frames_[frame] = readFrameHeader(frame);
+  decoded_[frame] = false;
+
+  size_t frame_size = frame_memory_[frame];
+  size_in_memory_ -= frame_size;
+  frame_memory_[frame] = 0;
+
+  return frame_size;
 }
 
 //------------------------------------------------------------------------------
@@ -149,26 +300,36 @@ void SlpFile::saveFile()
 #ifndef NDEBUG
   std::chrono::time_point<std::chrono::system_clock> startTime = std::chrono::system_clock::now();
 #endif
+  // Lazy frames have to be decoded before they can be encoded again. They
+  // are held here, so frames evicted by the cache meanwhile stay decoded.
+  FrameVector frames(getFrameCount());
+  for (uint16_t i = 0; i < frames.size(); ++i)
+  {
+    frames[i] = getFrame(i);
+  }
+
+  uint16_t frame_count;
+
   writeString(version, 4);
-  serializeSize<uint16_t>(num_frames_, frames_.size());
+  serializeSize<uint16_t>(frame_count, frames.size());
   write<uint16_t>(properties_);
   writeString(comment, 24);
 
-  uint32_t slp_offset = 32 + 32 * num_frames_;
+  uint32_t slp_offset = 32 + 32 * frame_count;
 
-  std::vector<SlpSaveData> save_data(num_frames_);
+  std::vector<SlpSaveData> save_data(frame_count);
 
   // Write frame headers
-  for (uint16_t i = 0; i < num_frames_; ++i)
+  for (uint16_t i = 0; i < frame_count; ++i)
   {
-    frames_[i]->buildSaveData(*getOStream(), slp_offset, save_data[i]);
-    frames_[i]->serializeHeader();
+    frames[i]->buildSaveData(*getOStream(), slp_offset, save_data[i]);
+    frames[i]->serializeHeader();
   }
 
   // Write frame content
-  for (uint16_t i = 0; i < num_frames_; ++i)
+  for (uint16_t i = 0; i < frame_count; ++i)
   {
-    frames_[i]->save(save_data[i]);
+    frames[i]->save(save_data[i]);
   }
 #ifndef NDEBUG
   std::chrono::time_point<std::chrono::system_clock> endTime = std::chrono::system_clock::now();
@@ -189,29 +350,51 @@ void SlpFile::unload(void)
   if (!loaded_)
     log.warn("Trying to unload a not loaded slpfile!");
 
+  if (cache_)
+    cache_->remove(this);
+
   frames_.clear();
   num_frames_ = 0;
 
+  std::vector<char>().swap(data_);
+  decoded_.clear();
+  frame_memory_.clear();
+
   loaded_ = false;
 }
 
 //------------------------------------------------------------------------------
 uint16_t SlpFile::getFrameCount(void) const
 {
+  std::lock_guard<std::mutex> lock(decode_mutex_);
   return static_cast<uint16_t>(frames_.size());
 }
 
 //------------------------------------------------------------------------------
 void SlpFile::setFrameCount(uint16_t count)
 {
+  std::lock_guard<std::mutex> lock(decode_mutex_);
+
   frames_.resize(count);
+  if (lazy_)
+  {
+    decoded_.resize(count, true);
+    frame_memory_.resize(count, 0);
+  }
   num_frames_ = count;
 }
 
+//------------------------------------------------------------------------------
+size_t SlpFile::getSizeInMemory(void) const
+{
+  std::lock_guard<std::mutex> lock(decode_mutex_);
+  return size_in_memory_;
+}
+
 //------------------------------------------------------------------------------
 SlpFramePtr SlpFile::getFrame(uint16_t frame)
 {
-  if (frame >= frames_.size())
+  if (frame >= getFrameCount())
   {
     if (!loaded_)
     {
@@ -225,6 +408,44 @@ SlpFramePtr SlpFile::getFrame(uint16_t frame)
     throw std::out_of_range("getFrame()");
   }
 
+  if (lazy_)
+  {
+    SlpFramePtr frame_ptr;
+    bool miss;
+    size_t decoded_size = 0;
+
+    {
+      std::lock_guard<std::mutex> lock(decode_mutex_);
+
+      // The frame count may have been changed since it was checked.
+      if (frame >= frames_.size())
+        throw std::out_of_range("getFrame()");
+
+      miss = !decoded_[frame];
+      if (miss)
+        decoded_size = decodeFrame(frame);
+
+      frame_ptr = frames_[frame];
+    }
+
+    // The cache may evict frames of this file, so it is told without the
+    // decode lock held.
+    if (cache_)
+    {
+      if (miss)
+        cache_->insert(this, frame, decoded_size);
+      else
+        cache_->touch(this, frame);
+    }
+
+    return frame_ptr;
+  }
+
+  std::lock_guard<std::mutex> lock(decode_mutex_);
+
+  if (frame >= frames_.size())
+    throw std::out_of_range("getFrame()");
+
   return frames_[frame];
 }
 
@@ -233,7 +454,16 @@ void SlpFile::setFrame(uint16_t frame, SlpFramePtr data)
 {
   if (frame < frames_.size())
   {
+    std::lock_guard<std::mutex> lock(decode_mutex_);
+
     frames_[frame] = data;
+
+    if (lazy_)
+    {
+      decoded_[frame] = true;
+      size_in_memory_ -= frame_memory_[frame];
+      frame_memory_[frame] = 0;
+    }
   }
 }
 
@@ -19,6 +19,9 @@
 
 #include "genie/resource/SlpFrame.h"
 
+#include <algorithm>
+#include <cstring>
+#include <exception>
 #include <iostream>
 //Debug
 #include <cassert>
@@ -26,6 +29,7 @@
 #include <chrono>
 
 #include "genie/resource/Color.h"
+#include "genie/util/WorkerPool.h"
 
 namespace genie
 {
@@ -428,9 +432,68 @@ void SlpFrame::serializeShadowHeader(void)
 }
 
 //------------------------------------------------------------------------------
-size_t SlpFrame::load(uint16_t properties)
+/// Bounds checked cursor over the commands of a row. Throws instead of
+/// reading past the end of the slp data.
+//
+struct SlpFrame::CommandReader
+{
+  const uint8_t *pos;
+  const uint8_t *end;
+
+  uint8_t byte(void)
+  {
+    if (pos >= end)
+      throw std::ios_base::failure("SlpFrame: Commands run past the data");
+
+    return *pos++;
+  }
+
+  const uint8_t *bytes(size_t count)
+  {
+    if (static_cast<size_t>(end - pos) < count)
+      throw std::ios_base::failure("SlpFrame: Commands run past the data");
+
+    const uint8_t *data = pos;
+    pos += count;
+    return data;
+  }
+};
+
+namespace
+{
+
+// Taller frames are split into row ranges of at least this many rows.
+const uint32_t MIN_ROWS_PER_THREAD = 64;
+
+//------------------------------------------------------------------------------
+template <typename T>
+bool readTable(const uint8_t *slp_data, size_t slp_size, uint32_t offset,
+               std::vector<T> &table)
+{
+  size_t bytes = table.size() * sizeof(T);
+
+  if (offset > slp_size || slp_size - offset < bytes)
+    return false;
+
+  if (bytes)
+    memcpy(table.data(), slp_data + offset, bytes);
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void appendMask(std::vector<T> &mask, const std::vector<T> &part)
+{
+  mask.insert(mask.end(), part.begin(), part.end());
+}
+
+}
+
+//------------------------------------------------------------------------------
+size_t SlpFrame::load(const uint8_t *slp_data, size_t slp_size,
+                      uint16_t properties, unsigned int row_threads)
 {
-  std::istream &istr = *getIStream();
   programmed_decay = properties == 32;
 
   if (is32bit())
@@ -443,51 +506,135 @@ size_t SlpFrame::load(uint16_t properties)
     img_data.alpha_channel.resize(width_ * height_, 0);
   }
 
+  // Left and right edge of each row
+  std::vector<uint16_t> edges(2 * height_);
+  std::vector<uint32_t> cmd_offsets(height_);
+
+  if (!readTable(slp_data, slp_size, outline_table_offset_, edges) ||
+      !readTable(slp_data, slp_size, cmd_table_offset_, cmd_offsets))
+  {
+    throw std::ios_base::failure("SlpFrame: Frame tables out of bounds");
+  }
+
   uint16_t integrity = 0;
-  istr.seekg(slp_file_pos_ + std::streampos(outline_table_offset_));
-  std::vector<uint16_t> left_edges(height_);
-  std::vector<uint16_t> right_edges(height_);
   for (uint32_t row = 0; row < height_; ++row)
   {
-    serialize<uint16_t>(left_edges[row]);
-    serialize<uint16_t>(right_edges[row]);
-    integrity |= left_edges[row];
+    integrity |= edges[2 * row];
   }
 
-  istr.seekg(slp_file_pos_ + std::streampos(cmd_table_offset_));
-  std::vector<uint32_t> cmd_offsets(height_);
-  serialize<uint32_t>(cmd_offsets, height_);
-
   // Read embedded palette
   if (properties_ == 0x78)
   {
-    istr.seekg(slp_file_pos_ + std::streampos(palette_offset_));
-    img_data.palette.resize(read<uint32_t>());
+    std::vector<uint32_t> color_count(1);
+    if (!readTable(slp_data, slp_size, palette_offset_, color_count) ||
+        (slp_size - palette_offset_ - 4) / 3 < color_count[0])
+    {
+      throw std::ios_base::failure("SlpFrame: Frame palette out of bounds");
+    }
+    img_data.palette.resize(color_count[0]);
+    const uint8_t *rgb = slp_data + palette_offset_ + 4;
     for (Color &rgba: img_data.palette)
     {
-      rgba.r = read<uint8_t>();
-      rgba.g = read<uint8_t>();
-      rgba.b = read<uint8_t>();
+      rgba.r = *rgb++;
+      rgba.g = *rgb++;
+      rgba.b = *rgb++;
     }
   }
 
   if (integrity != 0x8000) // At least one visible row.
+  {
+    // Rows only write their own pixels, so row ranges can be decoded on
+    // separate threads. Their masks are joined in row order afterwards.
+    uint32_t ranges = std::max<uint32_t>(1, std::min<uint32_t>(row_threads,
+      height_ / MIN_ROWS_PER_THREAD));
+
+    std::vector<SlpFrameData> range_masks(ranges - 1);
+    std::vector<uint8_t> range_ok(ranges, 0);
+    std::vector<std::exception_ptr> range_errors(ranges);
+
+    auto decodeRange = [&](uint32_t range) {
+      try
+      {
+        range_ok[range] = decodeRows(slp_data, slp_size,
+          height_ * range / ranges, height_ * (range + 1) / ranges,
+          edges, cmd_offsets, range ? range_masks[range - 1] : img_data);
+      }
+      catch (...)
+      {
+        range_errors[range] = std::current_exception();
+      }
+    };
+
+    WorkerPool::getGlobalPool().run(ranges, ranges, [&](size_t range) {
+      decodeRange(static_cast<uint32_t>(range));
+    });
+
+    for (std::exception_ptr &error : range_errors)
+    {
+      if (error)
+        std::rethrow_exception(error);
+    }
+
+    if (std::find(range_ok.begin(), range_ok.end(), 0) != range_ok.end())
+      return purge();
+
+    for (const SlpFrameData &masks : range_masks)
+    {
+      appendMask(img_data.shadow_mask, masks.shadow_mask);
+      appendMask(img_data.shield_mask, masks.shield_mask);
+      appendMask(img_data.outline_pc_mask, masks.outline_pc_mask);
+      appendMask(img_data.transparency_mask, masks.transparency_mask);
+      appendMask(img_data.player_color_mask, masks.player_color_mask);
+    }
+  }
+
+  full_width_ = width_;
+  full_height_ = height_;
+  full_hotspot_x_ = hotspot_x_;
+  full_hotspot_y_ = hotspot_y_;
+
+  size_t pixel_memory = img_data.pixel_indexes.capacity() * sizeof(uint8_t);
+  size_t alpha_memory = img_data.alpha_channel.capacity() * sizeof(uint8_t);
+  size_t bgra_memory = img_data.bgra_channels.capacity() * sizeof(uint32_t);
+
+  size_t shadow_memory = img_data.shadow_mask.capacity() * sizeof(XY16);
+  size_t shield_memory = img_data.shield_mask.capacity() * sizeof(XY16);
+  size_t outline_memory = img_data.outline_pc_mask.capacity() * sizeof(XY16);
+  size_t transparency_memory = img_data.transparency_mask.capacity() * sizeof(XY16);
+
+  size_t player_memory = img_data.player_color_mask.capacity() * sizeof(Color8XY16);
+  size_t special_memory = img_data.special_shadow_mask.capacity() * sizeof(Color8XY16);
+  size_t palette_memory = img_data.palette.capacity() * sizeof(genie::Color);
+
+  return sizeof(SlpFrame) + pixel_memory + alpha_memory + bgra_memory +
+    shadow_memory + shield_memory + outline_memory + transparency_memory +
+    player_memory + special_memory + palette_memory;
+}
+
+//------------------------------------------------------------------------------
+bool SlpFrame::decodeRows(const uint8_t *slp_data, size_t slp_size,
+                          uint32_t first_row, uint32_t end_row,
+                          const std::vector<uint16_t> &edges,
+                          const std::vector<uint32_t> &cmd_offsets,
+                          SlpFrameData &masks)
+{
   // Each row has its commands, 0x0F signals the end of a rows commands.
-  for (uint32_t row = 0; row < height_; ++row)
+  for (uint32_t row = first_row; row < end_row; ++row)
   {
-    istr.seekg(slp_file_pos_ + std::streampos(cmd_offsets[row]));
-    assert(!istr.eof());
-    // Transparent rows apparently read one byte anyway. NO THEY DO NOT! Ignore and use seekg()
-    if (0x8000 == left_edges[row] || 0x8000 == right_edges[row]) // Remember signedness!
+    uint16_t left_edge = edges[2 * row];
+    uint16_t right_edge = edges[2 * row + 1];
+    // Transparent rows apparently read one byte anyway. NO THEY DO NOT!
+    if (0x8000 == left_edge || 0x8000 == right_edge) // Remember signedness!
     {
       continue; // Pretend it does not exist.
     }
-    uint32_t pix_pos = left_edges[row]; //pos where to start putting pixels
+    CommandReader cmds{slp_data + std::min<size_t>(cmd_offsets[row], slp_size),
+                       slp_data + slp_size};
+    uint32_t pix_pos = left_edge; //pos where to start putting pixels
 
-    uint8_t data = 0;
     while (true)
     {
-      data = read<uint8_t>();
+      uint8_t data = cmds.byte();
 
       if (data == 0x0F) break;
 
@@ -504,9 +651,9 @@ size_t SlpFrame::load(uint16_t properties)
         case 0xC:
           pix_cnt = (data & 0xFC) >> 2;
           if (is32bit())
-            readPixelsToImage32(row, pix_pos, pix_cnt);
+            readPixelsToImage32(cmds, row, pix_pos, pix_cnt, masks);
           else
-            readPixelsToImage(row, pix_pos, pix_cnt);
+            readPixelsToImage(cmds, row, pix_pos, pix_cnt, masks);
           break;
 
         case 0x1: // Lesser skip (making pixels transparent)
@@ -518,45 +665,45 @@ size_t SlpFrame::load(uint16_t properties)
           break;
 
         case 0x2: // Greater block copy
-          pix_cnt = (sub << 4) + read<uint8_t>();
+          pix_cnt = (sub << 4) + cmds.byte();
           if (is32bit())
-            readPixelsToImage32(row, pix_pos, pix_cnt);
+            readPixelsToImage32(cmds, row, pix_pos, pix_cnt, masks);
           else
-            readPixelsToImage(row, pix_pos, pix_cnt);
+            readPixelsToImage(cmds, row, pix_pos, pix_cnt, masks);
           break;
 
         case 0x3: // Greater skip
-          pix_cnt = (sub << 4) + read<uint8_t>();
+          pix_cnt = (sub << 4) + cmds.byte();
           pix_pos += pix_cnt;
           break;
 
         case 0x6: // Copy and transform (player color)
-          pix_cnt = getPixelCountFromData(data);
+          pix_cnt = getPixelCountFromData(cmds, data);
           if (is32bit())
-            readPixelsToImage32(row, pix_pos, pix_cnt, 1);
+            readPixelsToImage32(cmds, row, pix_pos, pix_cnt, masks, 1);
           else
-            readPixelsToImage(row, pix_pos, pix_cnt, true);
+            readPixelsToImage(cmds, row, pix_pos, pix_cnt, masks, true);
           break;
 
         case 0x7: // Run of plain color
-          pix_cnt = getPixelCountFromData(data);
+          pix_cnt = getPixelCountFromData(cmds, data);
           if (is32bit())
-            setPixelsToColor32(row, pix_pos, pix_cnt);
+            setPixelsToColor32(cmds, row, pix_pos, pix_cnt, masks);
           else
-            setPixelsToColor(row, pix_pos, pix_cnt);
+            setPixelsToColor(cmds, row, pix_pos, pix_cnt, masks);
           break;
 
         case 0xA: // Transform block (player color)
-          pix_cnt = getPixelCountFromData(data);
+          pix_cnt = getPixelCountFromData(cmds, data);
           if (is32bit())
-            setPixelsToColor32(row, pix_pos, pix_cnt, true);
+            setPixelsToColor32(cmds, row, pix_pos, pix_cnt, masks, true);
           else
-            setPixelsToColor(row, pix_pos, pix_cnt, true);
+            setPixelsToColor(cmds, row, pix_pos, pix_cnt, masks, true);
           break;
 
         case 0xB: // Shadow pixels
-          pix_cnt = getPixelCountFromData(data);
-          setPixelsToShadow(row, pix_pos, pix_cnt);
+          pix_cnt = getPixelCountFromData(cmds, data);
+          setPixelsToMask(masks.shadow_mask, row, pix_pos, pix_cnt);
           break;
 
         case 0xE: // Extended commands
@@ -565,81 +712,61 @@ size_t SlpFrame::load(uint16_t properties)
             case 0x0E: // Forward draw
             case 0x1E: // Reverse draw
               log.error("Cmd [%X] is obsolete", data);
-              return purge();
+              return false;
 
             case 0x2E: // Normal transform
             case 0x3E: // Alternative transform
               log.error("Cmd [%X] is obsolete", data);
-              return purge();
+              return false;
 
             case 0x4E:
-              setPixelsToPcOutline(row, pix_pos, 1);
+              setPixelsToMask(masks.outline_pc_mask, row, pix_pos, 1);
               break;
             case 0x6E:
-              setPixelsToShield(row, pix_pos, 1);
+              setPixelsToMask(masks.shield_mask, row, pix_pos, 1);
               break;
 
             case 0x5E:
-              pix_cnt = read<uint8_t>();
-              setPixelsToPcOutline(row, pix_pos, pix_cnt);
+              pix_cnt = cmds.byte();
+              setPixelsToMask(masks.outline_pc_mask, row, pix_pos, pix_cnt);
               break;
             case 0x7E:
-              pix_cnt = read<uint8_t>();
-              setPixelsToShield(row, pix_pos, pix_cnt);
+              pix_cnt = cmds.byte();
+              setPixelsToMask(masks.shield_mask, row, pix_pos, pix_cnt);
               break;
 
             case 0x8E: // Dither
               log.error("Cmd [%X] not implemented", data);
-              return purge();
+              return false;
 
             case 0x9E: // Premultiplied alpha
             case 0xAE: // Original alpha
-              pix_cnt = read<uint8_t>();
+              pix_cnt = cmds.byte();
               if (is32bit())
               {
-                readPixelsToImage32(row, pix_pos, pix_cnt, 2);
+                readPixelsToImage32(cmds, row, pix_pos, pix_cnt, masks, 2);
                 break;
               }
 
             default:
               log.error("Cmd [%X] is unknown", data);
-              return purge();
+              return false;
           }
           break;
 
         default:
           log.error("Unknown cmd [%X]", data);
           std::cerr << "SlpFrame: Unknown cmd at " << std::hex << std::endl;
-          return purge();
+          return false;
       }
     }
   }
 
-  full_width_ = width_;
-  full_height_ = height_;
-  full_hotspot_x_ = hotspot_x_;
-  full_hotspot_y_ = hotspot_y_;
-
-  size_t pixel_memory = img_data.pixel_indexes.capacity() * sizeof(uint8_t);
-  size_t alpha_memory = img_data.alpha_channel.capacity() * sizeof(uint8_t);
-  size_t bgra_memory = img_data.bgra_channels.capacity() * sizeof(uint32_t);
-
-  size_t shadow_memory = img_data.shadow_mask.capacity() * sizeof(XY16);
-  size_t shield_memory = img_data.shield_mask.capacity() * sizeof(XY16);
-  size_t outline_memory = img_data.outline_pc_mask.capacity() * sizeof(XY16);
-  size_t transparency_memory = img_data.transparency_mask.capacity() * sizeof(XY16);
-
-  size_t player_memory = img_data.player_color_mask.capacity() * sizeof(Color8XY16);
-  size_t special_memory = img_data.special_shadow_mask.capacity() * sizeof(Color8XY16);
-  size_t palette_memory = img_data.palette.capacity() * sizeof(genie::Color);
-
-  return sizeof(SlpFrame) + pixel_memory + alpha_memory + bgra_memory +
-    shadow_memory + shield_memory + outline_memory + transparency_memory +
-    player_memory + special_memory + palette_memory;
+  return true;
 }
 
 //------------------------------------------------------------------------------
-size_t SlpFrame::loadSpecialShadow(void)
+size_t SlpFrame::loadSpecialShadow(const uint8_t *slp_data, size_t slp_size)
 {
   uint16_t properties = shadow_properties_ & 0xFFFF;
   int8_t palette_id = shadow_properties_ >> 16 & 255;
@@ -647,23 +774,22 @@ size_t SlpFrame::loadSpecialShadow(void)
 
   assert(shadow_palette_offset_ == 0);
 
-  std::istream &istr = *getIStream();
+  // Left and right edge of each row
+  std::vector<uint16_t> edges(2 * shadow_height_);
+  std::vector<uint32_t> cmd_offsets(shadow_height_);
+
+  if (!readTable(slp_data, slp_size, shadow_outline_table_offset_, edges) ||
+      !readTable(slp_data, slp_size, shadow_cmd_table_offset_, cmd_offsets))
+  {
+    throw std::ios_base::failure("SlpFrame: Shadow frame tables out of bounds");
+  }
 
   uint16_t integrity = 0;
-  istr.seekg(slp_file_pos_ + std::streampos(shadow_outline_table_offset_));
-  std::vector<uint16_t> left_edges(shadow_height_);
-  std::vector<uint16_t> right_edges(shadow_height_);
   for (uint32_t row = 0; row < shadow_height_; ++row)
   {
-    serialize<uint16_t>(left_edges[row]);
-    serialize<uint16_t>(right_edges[row]);
-    integrity |= left_edges[row];
+    integrity |= edges[2 * row];
   }
 
-  istr.seekg(slp_file_pos_ + std::streampos(shadow_cmd_table_offset_));
-  std::vector<uint32_t> cmd_offsets(shadow_height_);
-  serialize<uint32_t>(cmd_offsets, shadow_height_);
-
   // Should be no embedded palette
   assert(properties != 0x78);
 
@@ -671,18 +797,19 @@ size_t SlpFrame::loadSpecialShadow(void)
   // Each row has its commands, 0x0F signals the end of a rows commands.
   for (uint32_t row = 0; row < shadow_height_; ++row)
   {
-    istr.seekg(slp_file_pos_ + std::streampos(cmd_offsets[row]));
-    assert(!istr.eof());
-    if (0x8000 == left_edges[row] || 0x8000 == right_edges[row])
+    if (0x8000 == edges[2 * row] || 0x8000 == edges[2 * row + 1])
     {
       continue; // Pretend it does not exist.
     }
-    uint32_t pix_pos = left_edges[row]; //pos where to start putting pixels
+    uint32_t pix_pos = edges[2 * row]; //pos where to start putting pixels
+
+    CommandReader cmds{slp_data + std::min<size_t>(cmd_offsets[row], slp_size),
+                       slp_data + slp_size};
 
     uint8_t data = 0;
     while (pix_pos < shadow_width_)
     {
-      data = read<uint8_t>();
+      data = cmds.byte();
 
       if (data == 15) break;
 
@@ -697,7 +824,7 @@ size_t SlpFrame::loadSpecialShadow(void)
         case 0x8:
         case 0xC:
           pix_cnt = data >> 2 & 63;
-          readPixelsToSpecialShadow(row, pix_pos, pix_cnt);
+          readPixelsToSpecialShadow(cmds, row, pix_pos, pix_cnt);
           break;
 
         case 0x1: // Lesser skip (making pixels transparent)
@@ -709,18 +836,18 @@ size_t SlpFrame::loadSpecialShadow(void)
           break;
 
         case 0x2: // Greater block copy
-          pix_cnt = (sub << 4) + read<uint8_t>();
-          readPixelsToSpecialShadow(row, pix_pos, pix_cnt);
+          pix_cnt = (sub << 4) + cmds.byte();
+          readPixelsToSpecialShadow(cmds, row, pix_pos, pix_cnt);
           break;
 
         case 0x3: // Greater skip
-          pix_cnt = (sub << 4) + read<uint8_t>();
+          pix_cnt = (sub << 4) + cmds.byte();
           pix_pos += pix_cnt;
           break;
 
         case 0x7: // Run of plain color
-          pix_cnt = getPixelCountFromData(data);
-          setPixelsToSpecialShadow(row, pix_pos, pix_cnt);
+          pix_cnt = getPixelCountFromData(cmds, data);
+          setPixelsToSpecialShadow(cmds, row, pix_pos, pix_cnt);
           break;
 
         default:
@@ -741,157 +868,168 @@ size_t SlpFrame::loadSpecialShadow(void)
 }
 
 //------------------------------------------------------------------------------
-void SlpFrame::readPixelsToImage(uint32_t row, uint32_t &col,
-                                 uint32_t count, bool player_col)
+uint32_t SlpFrame::pixelsInRow(uint32_t col, uint32_t count) const
 {
-  uint32_t to_pos = col + count;
-  while (col < to_pos)
+  return col < width_ ? std::min(count, width_ - col) : 0;
+}
+
+//------------------------------------------------------------------------------
+void SlpFrame::readPixelsToImage(CommandReader &cmds, uint32_t row,
+                                 uint32_t &col, uint32_t count,
+                                 SlpFrameData &masks, bool player_col)
+{
+  const uint8_t *src = cmds.bytes(programmed_decay ? 2 * count : count);
+
+  uint32_t in_row = pixelsInRow(col, count);
+  if (in_row)
   {
+    uint8_t *pixels = img_data.pixel_indexes.data() + row * width_ + col;
     if (programmed_decay)
     {
-      read<uint8_t>();
+      // Every pixel is preceded by its decay byte.
+      for (uint32_t i = 0; i < in_row; ++i)
+        pixels[i] = src[2 * i + 1];
     }
-    uint8_t color_index = read<uint8_t>();
-    assert(row * width_ + col < img_data.pixel_indexes.size());
-    img_data.pixel_indexes[row * width_ + col] = color_index;
-    img_data.alpha_channel[row * width_ + col] = 255;
-    if (player_col)
+    else
     {
-      img_data.player_color_mask.emplace_back(col, row, color_index);
+      memcpy(pixels, src, in_row);
+    }
+    memset(img_data.alpha_channel.data() + row * width_ + col, 255, in_row);
+  }
+
+  if (player_col)
+  {
+    for (uint32_t i = 0; i < count; ++i)
+    {
+      uint8_t color_index = programmed_decay ? src[2 * i + 1] : src[i];
+      masks.player_color_mask.emplace_back(col + i, row, color_index);
     }
-    ++col;
   }
+  col += count;
 }
 
 //------------------------------------------------------------------------------
-void SlpFrame::readPixelsToImage32(uint32_t row, uint32_t &col,
-                                 uint32_t count, uint8_t special)
+void SlpFrame::readPixelsToImage32(CommandReader &cmds, uint32_t row,
+                                   uint32_t &col, uint32_t count,
+                                   SlpFrameData &masks, uint8_t special)
 {
-  uint32_t to_pos = col + count;
-  while (col < to_pos)
+  const uint8_t *src = cmds.bytes(4 * count);
+
+  uint32_t in_row = pixelsInRow(col, count);
+  if (in_row)
+    memcpy(img_data.bgra_channels.data() + row * width_ + col, src, 4 * in_row);
+
+  if (special == 1)
   {
-    uint32_t bgra = read<uint32_t>();
-    assert(row * width_ + col < img_data.bgra_channels.size());
-    img_data.bgra_channels[row * width_ + col] = bgra;
-    if (special == 1)
-    {
-      img_data.player_color_mask.emplace_back(col, row, 0);
-    }
-    else if (special == 2)
-    {
-      img_data.transparency_mask.emplace_back(col, row);
-    }
-    ++col;
+    for (uint32_t i = 0; i < count; ++i)
+      masks.player_color_mask.emplace_back(col + i, row, 0);
+  }
+  else if (special == 2)
+  {
+    for (uint32_t i = 0; i < count; ++i)
+      masks.transparency_mask.emplace_back(col + i, row);
   }
+  col += count;
 }
 
 //------------------------------------------------------------------------------
-void SlpFrame::readPixelsToSpecialShadow(uint32_t row, uint32_t &col, uint32_t count)
+void SlpFrame::readPixelsToSpecialShadow(CommandReader &cmds, uint32_t row,
+                                         uint32_t &col, uint32_t count)
 {
+  const uint8_t *src = cmds.bytes(count);
+
   uint32_t to_pos = col + count;
   while (col < to_pos)
   {
-    uint16_t color_index = read<uint8_t>() << 2;
+    uint16_t color_index = *src++ << 2;
     img_data.special_shadow_mask.emplace_back(col, row, 255 - color_index);
     ++col;
   }
 }
 
 //------------------------------------------------------------------------------
-void SlpFrame::setPixelsToColor(uint32_t row, uint32_t &col, uint32_t count,
-                                bool player_col)
+void SlpFrame::setPixelsToColor(CommandReader &cmds, uint32_t row,
+                                uint32_t &col, uint32_t count,
+                                SlpFrameData &masks, bool player_col)
 {
   if (programmed_decay)
   {
-    read<uint8_t>();
+    cmds.byte();
   }
-  uint8_t color_index = read<uint8_t>();
-  uint32_t to_pos = col + count;
-  while (col < to_pos)
+  uint8_t color_index = cmds.byte();
+
+  uint32_t in_row = pixelsInRow(col, count);
+  if (in_row)
   {
-    assert(row * width_ + col < img_data.pixel_indexes.size());
-    img_data.pixel_indexes[row * width_ + col] = color_index;
-    img_data.alpha_channel[row * width_ + col] = 255;
-    if (player_col)
-    {
-      img_data.player_color_mask.emplace_back(col, row, color_index);
-    }
-    ++col;
+    memset(img_data.pixel_indexes.data() + row * width_ + col, color_index, in_row);
+    memset(img_data.alpha_channel.data() + row * width_ + col, 255, in_row);
   }
-}
 
-//------------------------------------------------------------------------------
-void SlpFrame::setPixelsToColor32(uint32_t row, uint32_t &col, uint32_t count,
-                                bool player_col)
-{
-  uint32_t bgra = read<uint32_t>();
-  uint32_t to_pos = col + count;
-  while (col < to_pos)
+  if (player_col)
   {
-    assert(row * width_ + col < img_data.bgra_channels.size());
-    img_data.bgra_channels[row * width_ + col] = bgra;
-    if (player_col)
-    {
-      img_data.player_color_mask.emplace_back(col, row, 0);
-    }
-    ++col;
+    for (uint32_t i = 0; i < count; ++i)
+      masks.player_color_mask.emplace_back(col + i, row, color_index);
   }
+  col += count;
 }
 
 //------------------------------------------------------------------------------
-void SlpFrame::setPixelsToShadow(uint32_t row, uint32_t &col, uint32_t count)
+void SlpFrame::setPixelsToColor32(CommandReader &cmds, uint32_t row,
+                                  uint32_t &col, uint32_t count,
+                                  SlpFrameData &masks, bool player_col)
 {
-  uint32_t to_pos = col + count;
-  while (col < to_pos)
+  const uint8_t *src = cmds.bytes(4);
+
+  uint32_t in_row = pixelsInRow(col, count);
+  if (in_row)
   {
-    img_data.shadow_mask.emplace_back(col, row);
-    ++col;
+    uint32_t bgra;
+    memcpy(&bgra, src, sizeof(bgra));
+    std::fill_n(img_data.bgra_channels.data() + row * width_ + col, in_row, bgra);
   }
-}
 
-//------------------------------------------------------------------------------
-void SlpFrame::setPixelsToSpecialShadow(uint32_t row, uint32_t &col, uint32_t count)
-{
-  uint16_t color_index = read<uint8_t>() << 2;
-  uint32_t to_pos = col + count;
-  while (col < to_pos)
+  if (player_col)
   {
-    img_data.special_shadow_mask.emplace_back(col, row, 255 - color_index);
-    ++col;
+    for (uint32_t i = 0; i < count; ++i)
+      masks.player_color_mask.emplace_back(col + i, row, 0);
   }
+  col += count;
 }
 
 //------------------------------------------------------------------------------
-void SlpFrame::setPixelsToShield(uint32_t row, uint32_t &col, uint32_t count)
+void SlpFrame::setPixelsToMask(std::vector<XY16> &mask, uint32_t row,
+                               uint32_t &col, uint32_t count)
 {
   uint32_t to_pos = col + count;
   while (col < to_pos)
   {
-    img_data.shield_mask.emplace_back(col, row);
+    mask.emplace_back(col, row);
     ++col;
   }
 }
 
 //------------------------------------------------------------------------------
-void SlpFrame::setPixelsToPcOutline(uint32_t row, uint32_t &col, uint32_t count)
+void SlpFrame::setPixelsToSpecialShadow(CommandReader &cmds, uint32_t row,
+                                        uint32_t &col, uint32_t count)
 {
+  uint16_t color_index = cmds.byte() << 2;
   uint32_t to_pos = col + count;
   while (col < to_pos)
   {
-    img_data.outline_pc_mask.emplace_back(col, row);
+    img_data.special_shadow_mask.emplace_back(col, row, 255 - color_index);
     ++col;
   }
 }
 
 //------------------------------------------------------------------------------
-uint8_t SlpFrame::getPixelCountFromData(uint8_t data)
+uint8_t SlpFrame::getPixelCountFromData(CommandReader &cmds, uint8_t data)
 {
   uint8_t pix_cnt;
 
   data = (data & 0xF0) >> 4;
 
   if (data == 0)
-    pix_cnt = read<uint8_t>();
+    pix_cnt = cmds.byte();
   else
     pix_cnt = data;
 
@@ -23,11 +23,182 @@
 #include <stdexcept>
 #include <chrono>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
 #include "genie/resource/Color.h"
 
 namespace genie
 {
 
+namespace
+{
+
+//------------------------------------------------------------------------------
+/// Unpacks 4plus1 blocks: four low bytes followed by a byte holding the two
+/// high bits of each pixel, lowest bits belonging to the first pixel.
+//
+void unpack4Plus1Scalar(const uint8_t *packed, size_t block_count,
+                        uint16_t *pixels)
+{
+  for (size_t block = 0; block < block_count; ++block)
+  {
+    uint16_t high = packed[4];
+    pixels[0] = packed[0] | (high << 8 & 768);
+    pixels[1] = packed[1] | (high << 6 & 768);
+    pixels[2] = packed[2] | (high << 4 & 768);
+    pixels[3] = packed[3] | (high << 2 & 768);
+    packed += 5;
+    pixels += 4;
+  }
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GENIE_SMX_SIMD
+#define GENIE_SMX_TARGET(isa) __attribute__((target(isa)))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define GENIE_SMX_SIMD
+#define GENIE_SMX_TARGET(isa)
+#endif
+
+#ifdef GENIE_SMX_SIMD
+
+// Each 16 bit lane gets its low byte in the low half and the byte with the
+// high bits in the upper half. Covers two blocks.
+#define GENIE_SMX_4PLUS1_SHUFFLE \
+  0, 4, 1, 4, 2, 4, 3, 4, 5, 9, 6, 9, 7, 9, 8, 9
+
+// Multiplying by these moves the two high bits of each lane to bits 14-15.
+#define GENIE_SMX_4PLUS1_SHIFT 64, 16, 4, 1, 64, 16, 4, 1
+
+//------------------------------------------------------------------------------
+GENIE_SMX_TARGET("ssse3")
+void unpack4Plus1Ssse3(const uint8_t *packed, size_t block_count,
+                       uint16_t *pixels)
+{
+  const __m128i shuffle = _mm_setr_epi8(GENIE_SMX_4PLUS1_SHUFFLE);
+  const __m128i shift = _mm_setr_epi16(GENIE_SMX_4PLUS1_SHIFT);
+  const __m128i low_mask = _mm_set1_epi16(0x00FF);
+  const __m128i high_mask = _mm_set1_epi16(0x0300);
+
+  // Two blocks per step, the 16 byte load needs four blocks of input left.
+  size_t block = 0;
+  for (; block + 4 <= block_count; block += 2)
+  {
+    __m128i lanes = _mm_shuffle_epi8(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(packed)), shuffle);
+    __m128i low = _mm_and_si128(lanes, low_mask);
+    __m128i high = _mm_and_si128(
+      _mm_srli_epi16(_mm_mullo_epi16(lanes, shift), 6), high_mask);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(pixels),
+      _mm_or_si128(low, high));
+    packed += 10;
+    pixels += 8;
+  }
+
+  unpack4Plus1Scalar(packed, block_count - block, pixels);
+}
+
+//------------------------------------------------------------------------------
+GENIE_SMX_TARGET("avx2")
+void unpack4Plus1Avx2(const uint8_t *packed, size_t block_count,
+                      uint16_t *pixels)
+{
+  const __m256i shuffle = _mm256_setr_epi8(GENIE_SMX_4PLUS1_SHUFFLE,
+    GENIE_SMX_4PLUS1_SHUFFLE);
+  const __m256i shift = _mm256_setr_epi16(GENIE_SMX_4PLUS1_SHIFT,
+    GENIE_SMX_4PLUS1_SHIFT);
+  const __m256i low_mask = _mm256_set1_epi16(0x00FF);
+  const __m256i high_mask = _mm256_set1_epi16(0x0300);
+
+  // Four blocks per step, the second 16 byte load starts at the third block
+  // and needs six blocks of input left.
+  size_t block = 0;
+  for (; block + 6 <= block_count; block += 4)
+  {
+    __m256i bytes = _mm256_inserti128_si256(_mm256_castsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(packed))),
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(packed + 10)), 1);
+    __m256i lanes = _mm256_shuffle_epi8(bytes, shuffle);
+    __m256i low = _mm256_and_si256(lanes, low_mask);
+    __m256i high = _mm256_and_si256(
+      _mm256_srli_epi16(_mm256_mullo_epi16(lanes, shift), 6), high_mask);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(pixels),
+      _mm256_or_si256(low, high));
+    packed += 20;
+    pixels += 16;
+  }
+
+  unpack4Plus1Ssse3(packed, block_count - block, pixels);
+}
+
+#undef GENIE_SMX_4PLUS1_SHUFFLE
+#undef GENIE_SMX_4PLUS1_SHIFT
+
+//------------------------------------------------------------------------------
+bool cpuSupports(bool avx2)
+{
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 1);
+  if (!avx2)
+    return (info[2] & 1 << 9) != 0;
+
+  // AVX state has to be enabled by the OS as well.
+  if ((info[2] & 1 << 27) == 0 || (info[2] & 1 << 28) == 0 ||
+      (_xgetbv(0) & 6) != 6)
+    return false;
+
+  __cpuidex(info, 7, 0);
+  return (info[1] & 1 << 5) != 0;
+#else
+  __builtin_cpu_init();
+  return avx2 ? __builtin_cpu_supports("avx2") :
+    __builtin_cpu_supports("ssse3");
+#endif
+}
+
+#endif // GENIE_SMX_SIMD
+
+//------------------------------------------------------------------------------
+/// Picks the widest unpacker the cpu runs.
+//
+SmxFrame::Unpack4Plus1 selectUnpack4Plus1(void)
+{
+  return SmxFrame::get4Plus1Unpackers().back().unpack;
+}
+
+//------------------------------------------------------------------------------
+void unpack4Plus1(const uint8_t *packed, size_t block_count, uint16_t *pixels)
+{
+  static const SmxFrame::Unpack4Plus1 unpack = selectUnpack4Plus1();
+
+  unpack(packed, block_count, pixels);
+}
+
+//------------------------------------------------------------------------------
+/// Unpacks blocks of 8 bit palette layers: two 10 bit pixels in the low
+/// 20 bits of the first four bytes, the fifth byte is unused.
+//
+void unpack8BitPalette(const uint8_t *packed, size_t block_count,
+                       uint16_t *pixels)
+{
+  for (size_t block = 0; block < block_count; ++block)
+  {
+    uint32_t payload = packed[0] | packed[1] << 8 | packed[2] << 16;
+    pixels[0] = 1023 & payload;
+    pixels[1] = 1023 & payload >> 10;
+    packed += 5;
+    pixels += 2;
+  }
+}
+
+}
+
 Logger& SmxFrame::log = Logger::getLogger("genie.SmxFrame");
 extern const char* CNT_SETS;
 
@@ -41,6 +212,21 @@ SmxFrame::~SmxFrame()
 {
 }
 
+//------------------------------------------------------------------------------
+std::vector<SmxFrame::Unpacker4Plus1> SmxFrame::get4Plus1Unpackers(void)
+{
+  std::vector<Unpacker4Plus1> unpackers = {{"scalar", unpack4Plus1Scalar}};
+
+#ifdef GENIE_SMX_SIMD
+  if (cpuSupports(false))
+    unpackers.push_back({"ssse3", unpack4Plus1Ssse3});
+  if (cpuSupports(true))
+    unpackers.push_back({"avx2", unpack4Plus1Avx2});
+#endif
+
+  return unpackers;
+}
+
 void SmxFrame::findMaximumExtents(void)
 {
   hotspot_x_ = std::max<int16_t>(main_layer_.hotspot_x, std::max<int16_t>(shadow_layer_.hotspot_x, outline_layer_.hotspot_x));
@@ -106,35 +292,22 @@ size_t SmxFrame::load(std::istream &istr)
     }
     std::vector<uint16_t> pixel_data;
     size_t block_count = pixel_data_size / 5;
-    if (layer_flags & 8)
     {
-      pixel_data.reserve(block_count * 2);
-      for (size_t block = 0; block < block_count; ++block)
+      std::vector<uint8_t> packed(pixel_data_size);
+      if (pixel_data_size)
       {
-        uint32_t payload = read<uint32_t>();
-        pixel_data.push_back(1023 & payload);
-        pixel_data.push_back(1023 & payload >> 10);
-        read<uint8_t>();
+        uint8_t *packed_data = packed.data();
+        read<uint8_t>(&packed_data, pixel_data_size);
       }
-    }
-    else
-    {
-      pixel_data.reserve(block_count * 4);
-      for (size_t block = 0; block < block_count; ++block)
+      if (layer_flags & 8)
+      {
+        pixel_data.resize(block_count * 2);
+        unpack8BitPalette(packed.data(), block_count, pixel_data.data());
+      }
+      else
       {
-        uint16_t byte1 = read<uint8_t>();
-        uint16_t byte2 = read<uint8_t>();
-        uint16_t byte3 = read<uint8_t>();
-        uint16_t byte4 = read<uint8_t>();
-        uint16_t byte5 = read<uint8_t>();
-        byte1 |= byte5 << 8 & 768;
-        byte2 |= byte5 << 6 & 768;
-        byte3 |= byte5 << 4 & 768;
-        byte4 |= byte5 << 2 & 768;
-        pixel_data.push_back(byte1);
-        pixel_data.push_back(byte2);
-        pixel_data.push_back(byte3);
-        pixel_data.push_back(byte4);
+        pixel_data.resize(block_count * 4);
+        unpack4Plus1(packed.data(), block_count, pixel_data.data());
       }
     }
 
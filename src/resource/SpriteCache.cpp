@@ -0,0 +1,198 @@
+/*
+    genieutils - A library for reading and writing data files of genie
+               engine games.
+    Copyright (C) 2011 - 2013  Armin Preiml
+    Copyright (C) 2011 - 2021  Mikko "Tapsa" P
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "genie/resource/SpriteCache.h"
+
+#include <iterator>
+
+namespace genie
+{
+
+//------------------------------------------------------------------------------
+SpriteCache::SpriteCache(size_t budget) : budget_(budget)
+{
+}
+
+//------------------------------------------------------------------------------
+SpriteCache::~SpriteCache()
+{
+}
+
+//------------------------------------------------------------------------------
+SpriteCache &SpriteCache::getGlobalCache(void)
+{
+  static SpriteCache cache;
+  return cache;
+}
+
+//------------------------------------------------------------------------------
+void SpriteCache::setBudget(size_t budget)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  budget_ = budget;
+  evictOverBudget();
+}
+
+//------------------------------------------------------------------------------
+size_t SpriteCache::getBudget(void) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return budget_;
+}
+
+//------------------------------------------------------------------------------
+size_t SpriteCache::getSize(void) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_;
+}
+
+//------------------------------------------------------------------------------
+uint64_t SpriteCache::getHits(void) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+//------------------------------------------------------------------------------
+uint64_t SpriteCache::getMisses(void) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return misses_;
+}
+
+//------------------------------------------------------------------------------
+uint64_t SpriteCache::getEvictions(void) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return evictions_;
+}
+
+//------------------------------------------------------------------------------
+void SpriteCache::resetCounters(void)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  hits_ = 0;
+  misses_ = 0;
+  evictions_ = 0;
+}
+
+//------------------------------------------------------------------------------
+void SpriteCache::clear(void)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  while (!entries_.empty())
+  {
+    evict(std::prev(entries_.end()));
+  }
+}
+
+//------------------------------------------------------------------------------
+void SpriteCache::touch(SpriteFile *file, uint16_t frame)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  ++hits_;
+
+  // Frames decoded before the file joined the cache are not tracked.
+  EntryMap::iterator it = index_.find(std::make_pair(file, frame));
+  if (it != index_.end())
+  {
+    entries_.splice(entries_.begin(), entries_, it->second);
+  }
+}
+
+//------------------------------------------------------------------------------
+void SpriteCache::insert(SpriteFile *file, uint16_t frame, size_t bytes)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  ++misses_;
+
+  std::pair<SpriteFile *, uint16_t> key(file, frame);
+  EntryMap::iterator it = index_.find(key);
+
+  if (it != index_.end())
+  {
+    size_ -= it->second->bytes;
+    it->second->bytes = bytes;
+    entries_.splice(entries_.begin(), entries_, it->second);
+  }
+  else
+  {
+    entries_.push_front(Entry{file, frame, bytes});
+    index_.emplace(key, entries_.begin());
+  }
+
+  size_ += bytes;
+
+  evictOverBudget();
+}
+
+//------------------------------------------------------------------------------
+void SpriteCache::remove(SpriteFile *file)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  for (EntryList::iterator it = entries_.begin(); it != entries_.end();)
+  {
+    if (it->file == file)
+    {
+      size_ -= it->bytes;
+      index_.erase(std::make_pair(it->file, it->frame));
+      it = entries_.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void SpriteCache::evictOverBudget(void)
+{
+  if (budget_ == 0)
+    return;
+
+  while (size_ > budget_ && entries_.size() > 1)
+  {
+    evict(std::prev(entries_.end()));
+  }
+}
+
+//------------------------------------------------------------------------------
+void SpriteCache::evict(EntryList::iterator entry)
+{
+  // Files take their own lock in evictFrame, they never call the cache
+  // while holding it, so locking in this order can't deadlock.
+  entry->file->evictFrame(entry->frame);
+
+  size_ -= entry->bytes;
+  index_.erase(std::make_pair(entry->file, entry->frame));
+  entries_.erase(entry);
+
+  ++evictions_;
+}
+
+}
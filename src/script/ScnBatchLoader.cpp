@@ -0,0 +1,298 @@
+/*
+    genieutils - A library for reading and writing data files of genie
+               engine games.
+    Copyright (C) 2011 - 2013  Armin Preiml
+    Copyright (C) 2011 - 2021  Mikko "Tapsa" P
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "genie/script/ScnBatchLoader.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+
+#include "genie/util/WorkerPool.h"
+
+namespace genie
+{
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+/// Files queued for one worker. The owner takes from the back, thieves from
+/// the front.
+//
+struct WorkQueue
+{
+  std::mutex mutex;
+  std::deque<size_t> items;
+};
+
+//------------------------------------------------------------------------------
+/// Blocks workers while the files in flight exceed the memory limit.
+//
+class MemoryGate
+{
+public:
+  MemoryGate(size_t limit) : limit_(limit)
+  {
+  }
+
+  void acquire(size_t bytes)
+  {
+    if (limit_ == 0)
+      return;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    released_.wait(lock, [&] {
+      return inFlight_ == 0 || inFlight_ + bytes <= limit_;
+    });
+
+    inFlight_ += bytes;
+  }
+
+  void release(size_t bytes)
+  {
+    if (limit_ == 0)
+      return;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      inFlight_ -= bytes;
+    }
+
+    released_.notify_all();
+  }
+
+private:
+  size_t limit_;
+  size_t inFlight_ = 0;
+
+  std::mutex mutex_;
+  std::condition_variable released_;
+};
+
+//------------------------------------------------------------------------------
+bool popOwn(WorkQueue &queue, size_t &item)
+{
+  std::lock_guard<std::mutex> lock(queue.mutex);
+
+  if (queue.items.empty())
+    return false;
+
+  item = queue.items.back();
+  queue.items.pop_back();
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool steal(WorkQueue &queue, size_t &item)
+{
+  std::lock_guard<std::mutex> lock(queue.mutex);
+
+  if (queue.items.empty())
+    return false;
+
+  item = queue.items.front();
+  queue.items.pop_front();
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+size_t fileSize(const std::string &path)
+{
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+
+  if (file.fail())
+    return 0;
+
+  return static_cast<size_t>(file.tellg());
+}
+
+}
+
+//------------------------------------------------------------------------------
+ScnBatchLoader::ScnBatchLoader(unsigned int threadCount, size_t memoryLimit) :
+  memoryLimit_(memoryLimit)
+{
+  setThreadCount(threadCount);
+}
+
+//------------------------------------------------------------------------------
+ScnBatchLoader::~ScnBatchLoader()
+{
+}
+
+//------------------------------------------------------------------------------
+void ScnBatchLoader::setThreadCount(unsigned int threadCount)
+{
+  threadCount_ = WorkerPool::resolveThreadCount(threadCount);
+}
+
+//------------------------------------------------------------------------------
+unsigned int ScnBatchLoader::getThreadCount(void) const
+{
+  return threadCount_;
+}
+
+//------------------------------------------------------------------------------
+void ScnBatchLoader::setMemoryLimit(size_t memoryLimit)
+{
+  memoryLimit_ = memoryLimit;
+}
+
+//------------------------------------------------------------------------------
+size_t ScnBatchLoader::getMemoryLimit(void) const
+{
+  return memoryLimit_;
+}
+
+//------------------------------------------------------------------------------
+void ScnBatchLoader::setMemoryPerFileByte(size_t bytes)
+{
+  memoryPerFileByte_ = bytes;
+}
+
+//------------------------------------------------------------------------------
+size_t ScnBatchLoader::getMemoryPerFileByte(void) const
+{
+  return memoryPerFileByte_;
+}
+
+//------------------------------------------------------------------------------
+std::vector<ScnBatchLoader::Result> ScnBatchLoader::load(
+  const std::vector<std::string> &paths)
+{
+  std::vector<Result> results(paths.size());
+
+  load(paths, [&](Result &result) {
+    results[result.index] = std::move(result);
+  });
+
+  return results;
+}
+
+//------------------------------------------------------------------------------
+void ScnBatchLoader::load(const std::vector<std::string> &paths,
+                          const ResultSink &sink)
+{
+  size_t workers = std::min<size_t>(threadCount_, paths.size());
+
+  if (workers == 0)
+    return;
+
+  // Deal out files round robin, so every worker starts with a similar mix.
+  std::vector<WorkQueue> queues(workers);
+
+  for (size_t i = 0; i < paths.size(); ++i)
+    queues[i % workers].items.push_back(i);
+
+  MemoryGate gate(memoryLimit_);
+
+  std::mutex sinkMutex;
+  std::exception_ptr sinkError;
+
+  auto loadOne = [&](size_t i) {
+    Result result;
+    result.index = i;
+    result.path = paths[i];
+
+    size_t bytes = fileSize(paths[i]) * memoryPerFileByte_;
+    gate.acquire(bytes);
+
+    try
+    {
+      std::shared_ptr<ScnFile> file = std::make_shared<ScnFile>();
+      file->load(paths[i].c_str());
+      file->freelock();
+
+      result.file = file;
+    }
+    catch (const std::exception &e)
+    {
+      result.error = e.what();
+    }
+    catch (...)
+    {
+      result.error = "Unknown error";
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(sinkMutex);
+
+      if (!sinkError)
+      {
+        try
+        {
+          sink(result);
+        }
+        catch (...)
+        {
+          sinkError = std::current_exception();
+        }
+      }
+    }
+
+    // The file counts until the sink is done with it.
+    result.file.reset();
+    gate.release(bytes);
+  };
+
+  auto failed = [&]() {
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    return bool(sinkError);
+  };
+
+  // No work is added while loading, so a worker that finds every queue
+  // empty is done.
+  auto work = [&](size_t self) {
+    size_t item;
+
+    while (!failed())
+    {
+      if (popOwn(queues[self], item))
+      {
+        loadOne(item);
+        continue;
+      }
+
+      bool stolen = false;
+
+      for (size_t n = 1; n < workers && !stolen; ++n)
+        stolen = steal(queues[(self + n) % workers], item);
+
+      if (!stolen)
+        break;
+
+      loadOne(item);
+    }
+  };
+
+  WorkerPool::getGlobalPool().run(workers,
+    static_cast<unsigned int>(workers), work);
+
+  if (sinkError)
+    std::rethrow_exception(sinkError);
+}
+
+}
@@ -26,15 +26,9 @@
 namespace genie
 {
 
-std::string ISerializable::scn_ver = "0.00";
-float ISerializable::scn_plr_data_ver = 0.f;
-float ISerializable::scn_internal_ver = 0.f;
-double ISerializable::scn_trigger_ver = 0.0;
-
 //------------------------------------------------------------------------------
 ScnFile::ScnFile() : IFile(), compressor_(this)
 {
-  scn_internal_ver = 0.f;
 }
 
 //------------------------------------------------------------------------------
@@ -42,6 +36,12 @@ ScnFile::~ScnFile()
 {
 }
 
+//------------------------------------------------------------------------------
+void ScnFile::saveAs(const char *fileName)
+{
+  saveBuffered(fileName);
+}
+
 void ScnFile::extractRaw(const char *from, const char *to)
 {
   std::ifstream ifs;
@@ -70,6 +70,31 @@ void ScnFile::extractRaw(const char *from, const char *to)
   ofs.close();
 }
 
+//------------------------------------------------------------------------------
+void ScnFile::peekHeader(const char *fileName, bool playerNames)
+{
+  // Read through a stream of its own, so the object is not tied to a file
+  // that was only partly read and save() can't overwrite it.
+  std::ifstream file(fileName, std::ios::binary);
+
+  if (file.fail())
+    throw std::ios_base::failure("Cant read file: \"" + std::string(fileName) + "\"");
+
+  peek_ = playerNames ? PEEK_PLAYER_NAMES : PEEK_HEADER;
+
+  try
+  {
+    readObject(file);
+  }
+  catch (...)
+  {
+    peek_ = PEEK_NONE;
+    throw;
+  }
+
+  peek_ = PEEK_NONE;
+}
+
 //------------------------------------------------------------------------------
 uint32_t ScnFile::getSeparator(void)
 {
@@ -79,6 +104,8 @@ uint32_t ScnFile::getSeparator(void)
 //------------------------------------------------------------------------------
 void ScnFile::serializeObject(void)
 {
+  SerializationContext &ctx = getContext();
+
   serializeVersion();
   if (isOperation(OP_WRITE))
   {
@@ -93,24 +120,33 @@ void ScnFile::serializeObject(void)
     serialize<uint32_t>(playerCount);
   }
 
-  std::cout << "Start compression: " << tellg() << std::endl;
+  if (isOperation(OP_READ) && peek_ == PEEK_HEADER)
+    return;
+
   compressor_.beginCompression();
-  std::cout << "Start compression: " << tellg() << std::endl;
 
 // Compressed header:
 
   serialize<uint32_t>(nextUnitID);
 
+  ctx.scn_player_names_only = isOperation(OP_READ) && peek_ == PEEK_PLAYER_NAMES;
+
   serialize<ISerializable>(playerData);
 
+  if (ctx.scn_player_names_only)
+  {
+    compressor_.endCompression();
+    return;
+  }
+
   serialize<ISerializable>(map);
 
-  if (scn_ver == "1.20" || scn_ver == "1.21") scn_internal_ver = 1.14f;
-  else if (scn_ver == "1.17" || scn_ver == "1.18" || scn_ver == "1.19") scn_internal_ver = 1.13f;
-  else if (scn_ver == "1.14" || scn_ver == "1.15" || scn_ver == "1.16") scn_internal_ver = 1.12f;
+  if (ctx.scn_ver == "1.20" || ctx.scn_ver == "1.21") ctx.scn_internal_ver = 1.14f;
+  else if (ctx.scn_ver == "1.17" || ctx.scn_ver == "1.18" || ctx.scn_ver == "1.19") ctx.scn_internal_ver = 1.13f;
+  else if (ctx.scn_ver == "1.14" || ctx.scn_ver == "1.15" || ctx.scn_ver == "1.16") ctx.scn_internal_ver = 1.12f;
 
   serializeSize<uint32_t>(playerCount1_, playerUnits.size());
-  if (scn_internal_ver > 1.06f)
+  if (ctx.scn_internal_ver > 1.06f)
     serializeSub<ScnPlayerResources>(playerResources, 8);
   else
   {
@@ -121,18 +157,17 @@ void ScnFile::serializeObject(void)
   serialize<uint32_t>(playerCount2_);
   serializeSub<ScnMorePlayerData>(players, 8);
 
-  triggerVersion = scn_trigger_ver;
   serialize<double>(triggerVersion);
-  scn_trigger_ver = triggerVersion;
+  ctx.scn_trigger_ver = triggerVersion;
 
-  if (scn_trigger_ver > 1.4f)
+  if (ctx.scn_trigger_ver > 1.4f)
     serialize<uint8_t>(objectivesStartingState);
   serializeSize<uint32_t>(numTriggers_, triggers.size());
   serializeSub<Trigger>(triggers, numTriggers_);
-  if (scn_trigger_ver > 1.3f)
+  if (ctx.scn_trigger_ver > 1.3f)
     serialize<int32_t>(triggerDisplayOrder, numTriggers_);
 
-  if (scn_ver == "1.21" || scn_ver == "1.20" || scn_ver == "1.19" || scn_ver == "1.18")
+  if (ctx.scn_ver == "1.21" || ctx.scn_ver == "1.20" || ctx.scn_ver == "1.19" || ctx.scn_ver == "1.18")
   {
     serialize<uint32_t>(includeFiles);
     serialize<uint32_t>(perErrorIncluded);
@@ -235,9 +270,8 @@ void ScnFile::serializeVersion(void)
     }
   }*/
 
-  version = scn_ver;
   serialize(version, 4);
-  scn_ver = version;
+  getContext().scn_ver = version;
 }
 
 //------------------------------------------------------------------------------
@@ -270,9 +304,8 @@ void ScnMainPlayerData::serializePlayerDataVersion(void)
     }
   }*/
 
-  playerDataVersion = scn_plr_data_ver;
   serialize<float>(playerDataVersion);
-  scn_plr_data_ver = playerDataVersion;
+  getContext().scn_plr_data_ver = playerDataVersion;
 
   /*if (isOperation(OP_READ))
   {
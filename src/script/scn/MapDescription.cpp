@@ -22,38 +22,115 @@
 #include "genie/script/scn/MapDescription.h"
 #include "genie/script/ScnFile.h"
 
+#include <algorithm>
+
 namespace genie
 {
 
-ScnMap::ScnMap()
+ScnMap::ScnMap() : tiles(this)
+{
+}
+
+// The tiles view stays bound to its own map.
+ScnMap::ScnMap(const ScnMap &other) : ISerializable(other),
+  width(other.width), height(other.height), terrainIDs(other.terrainIDs),
+  elevations(other.elevations), unused(other.unused), tiles(this)
 {
 }
 
+ScnMap &ScnMap::operator=(const ScnMap &other)
+{
+  ISerializable::operator=(other);
+
+  width = other.width;
+  height = other.height;
+  terrainIDs = other.terrainIDs;
+  elevations = other.elevations;
+  unused = other.unused;
+
+  return *this;
+}
+
 ScnMap::~ScnMap()
 {
 }
 
-void ScnMap::serializeObject(void)
+size_t ScnMap::getTileCount(void) const
 {
-  serialize<uint32_t>(width);
-  serialize<uint32_t>(height);
+  return terrainIDs.size();
+}
 
-  serializeSub<MapTile>(tiles, width * height);
+MapTile ScnMap::getTile(size_t index) const
+{
+  MapTile tile;
+  tile.terrainID = terrainIDs[index];
+  tile.elevation = elevations[index];
+  tile.unused = unused[index];
+  return tile;
 }
 
-MapTile::MapTile()
+void ScnMap::setTile(size_t index, const MapTile &tile)
 {
+  terrainIDs[index] = tile.terrainID;
+  elevations[index] = tile.elevation;
+  unused[index] = tile.unused;
 }
 
-MapTile::~MapTile()
+void ScnMap::resize(uint32_t width, uint32_t height)
 {
+  this->width = width;
+  this->height = height;
+
+  size_t count = size_t(width) * height;
+  terrainIDs.resize(count);
+  elevations.resize(count);
+  unused.resize(count);
 }
 
-void MapTile::serializeObject(void)
+void ScnMap::serializeObject(void)
 {
-  serialize<uint8_t>(terrainID);
-  serialize<uint8_t>(elevation);
-  serialize<uint8_t>(unused);
+  serialize<uint32_t>(width);
+  serialize<uint32_t>(height);
+
+  if (isOperation(OP_READ))
+    resize(width, height);
+
+  // Tiles are stored as three bytes each, they are moved a row at a time.
+  std::vector<uint8_t> row;
+  size_t rowSize = 3 * size_t(width);
+
+  if (!isOperation(OP_READ))
+    row.resize(rowSize);
+
+  for (size_t y = 0; y < height; ++y)
+  {
+    size_t first = y * width;
+
+    if (isOperation(OP_WRITE))
+    {
+      if (first + width > terrainIDs.size())
+        std::fill(row.begin(), row.end(), 0);
+
+      for (size_t x = 0; x < width && first + x < terrainIDs.size(); ++x)
+      {
+        row[3 * x] = terrainIDs[first + x];
+        row[3 * x + 1] = elevations[first + x];
+        row[3 * x + 2] = unused[first + x];
+      }
+    }
+
+    serialize<uint8_t>(row, rowSize);
+
+    if (isOperation(OP_READ))
+    {
+      for (size_t x = 0; x < width; ++x)
+      {
+        terrainIDs[first + x] = row[3 * x];
+        elevations[first + x] = row[3 * x + 1];
+        unused[first + x] = row[3 * x + 2];
+      }
+    }
+  }
 }
 
 }
@@ -25,8 +25,6 @@
 namespace genie
 {
 
-bool CombinedResources::playerInfo = false;
-
 ScnMainPlayerData::ScnMainPlayerData() : playerNames(16)
 {
 }
@@ -39,46 +37,47 @@ ScnMainPlayerData::~ScnMainPlayerData()
 
 void ScnMainPlayerData::serializeObject(void)
 {
+  SerializationContext &ctx = getContext();
+
   serializePlayerDataVersion();
-  if (scn_plr_data_ver > 1.13f)
+  if (ctx.scn_plr_data_ver > 1.13f)
   {
     for (unsigned int i=0; i<16; ++i)
       serialize(playerNames[i], 256); // 1.14 <-- this is read much later in AoE 1
-    if (scn_plr_data_ver > 1.15f)
+    if (ctx.scn_plr_data_ver > 1.15f)
       serialize<int32_t>(playerNamesStringTable, 16);
-    CombinedResources::playerInfo = true;
+    if (ctx.scn_player_names_only)
+      return;
+    ctx.scn_player_info = true;
     serializeSub<CombinedResources>(resourcesPlusPlayerInfo, 16);
   }
-  if (scn_plr_data_ver > 1.06f)
+  if (ctx.scn_plr_data_ver > 1.06f)
     serialize<uint8_t>(conquestVictory);
   serialize<ISerializable>(unknownData);
   serializeSizedString<uint16_t>(originalFileName, false);
 
-  if (scn_plr_data_ver > 1.15f)
+  if (ctx.scn_plr_data_ver > 1.15f)
   {
-    serialize<int32_t>(instructionsStringTable);
-    serialize<int32_t>(hintsStringTable);
-    serialize<int32_t>(victoryStringTable);
-    serialize<int32_t>(lossStringTable);
-    serialize<int32_t>(historyStringTable);
+    serializeFields(instructionsStringTable, hintsStringTable,
+      victoryStringTable, lossStringTable, historyStringTable);
 
-    if (scn_plr_data_ver > 1.21f)
+    if (ctx.scn_plr_data_ver > 1.21f)
       serialize<int32_t>(scoutsStringTable);
   }
 
   serializeSizedString<uint16_t>(instructions, false);
-  if (scn_plr_data_ver > 1.1f)
+  if (ctx.scn_plr_data_ver > 1.1f)
   {
     serializeSizedString<uint16_t>(hints, false);
     serializeSizedString<uint16_t>(victory, false);
     serializeSizedString<uint16_t>(loss, false);
     serializeSizedString<uint16_t>(history, false);
 
-    if (scn_plr_data_ver > 1.21f)
+    if (ctx.scn_plr_data_ver > 1.21f)
       serializeSizedString<uint16_t>(scouts, false);
   }
 
-  if (scn_plr_data_ver < 1.03f)
+  if (ctx.scn_plr_data_ver < 1.03f)
   {
     serializeSizedString<uint16_t>(oldFilename1, false);
     serializeSizedString<uint16_t>(oldFilename2, false);
@@ -88,23 +87,23 @@ void ScnMainPlayerData::serializeObject(void)
   serializeSizedString<uint16_t>(pregameCinematicFilename, false);
   serializeSizedString<uint16_t>(victoryCinematicFilename, false);
   serializeSizedString<uint16_t>(lossCinematicFilename, false);
-  if (scn_plr_data_ver > 1.08f)
+  if (ctx.scn_plr_data_ver > 1.08f)
     serializeSizedString<uint16_t>(backgroundFilename, false);
-  if (scn_plr_data_ver > 1.0f)
+  if (ctx.scn_plr_data_ver > 1.0f)
     serializeBitmap();
 
   serializeSizedStrings<uint16_t>(aiNames, 16, false);
   serializeSizedStrings<uint16_t>(cityNames, 16, false);
-  if (scn_plr_data_ver > 1.07f)
+  if (ctx.scn_plr_data_ver > 1.07f)
     serializeSizedStrings<uint16_t>(personalityNames, 16, false);
   serializeSub(aiFiles, 16);
-  if (scn_plr_data_ver > 1.1f)
+  if (ctx.scn_plr_data_ver > 1.1f)
     serialize<uint8_t>(aiTypes, 16);
-  if (scn_plr_data_ver > 1.01f)
+  if (ctx.scn_plr_data_ver > 1.01f)
     serialize<uint32_t>(separator_);
   // <- here actually switches the reading function in exe
 
-  if (scn_plr_data_ver < 1.14f)
+  if (ctx.scn_plr_data_ver < 1.14f)
   {
     for (unsigned int i=0; i<16; ++i)
       serialize(playerNames[i], 256);
@@ -112,43 +111,43 @@ void ScnMainPlayerData::serializeObject(void)
   }
   else
   {
-    CombinedResources::playerInfo = false;
+    ctx.scn_player_info = false;
     serializeSub<CombinedResources>(resourcesPlusPlayerInfo, 16);
   }
-  if (scn_plr_data_ver > 1.01f)
+  if (ctx.scn_plr_data_ver > 1.01f)
     serialize<uint32_t>(separator_);
   serialize<ISerializable>(victoryConditions);
   serialize<ISerializable>(diplomacy);
-  if (scn_plr_data_ver > 1.01f)
+  if (ctx.scn_plr_data_ver > 1.01f)
     serialize<uint32_t>(separator_);
-  serialize<uint32_t>(alliedVictory, scn_plr_data_ver < 1.02f ? 16*16 : 16);
-  if (scn_plr_data_ver > 1.03f)
+  serialize<uint32_t>(alliedVictory, ctx.scn_plr_data_ver < 1.02f ? 16*16 : 16);
+  if (ctx.scn_plr_data_ver > 1.03f)
   {
-    if (scn_plr_data_ver > 1.22f)
+    if (ctx.scn_plr_data_ver > 1.22f)
       serialize<uint32_t>(unused1);
     serialize<ISerializable>(disables);
-    if (scn_plr_data_ver > 1.04f)
+    if (ctx.scn_plr_data_ver > 1.04f)
     {
       serialize<uint32_t>(unused1);
-      if (scn_plr_data_ver > 1.11f)
+      if (ctx.scn_plr_data_ver > 1.11f)
       {
         serialize<uint32_t>(unused2);
         serialize<uint32_t>(allTechs);
       }
-      if (scn_plr_data_ver > 1.05f)
+      if (ctx.scn_plr_data_ver > 1.05f)
         serialize<uint32_t>(startingAge, 16);
     }
   }
-  if (scn_plr_data_ver > 1.01f)
+  if (ctx.scn_plr_data_ver > 1.01f)
     serialize<uint32_t>(separator_);
-  if (scn_plr_data_ver > 1.18f)
+  if (ctx.scn_plr_data_ver > 1.18f)
   {
     serialize<int32_t>(player1CameraX);
     serialize<int32_t>(player1CameraY);
-    if (scn_plr_data_ver > 1.2f)
+    if (ctx.scn_plr_data_ver > 1.2f)
     {
       serialize<int32_t>(aiType);
-      if (scn_plr_data_ver > 1.23f)
+      if (ctx.scn_plr_data_ver > 1.23f)
         serialize<uint8_t>(aiTypes, 16);
     }
   }
@@ -165,26 +164,23 @@ CombinedResources::~CombinedResources()
 
 void CombinedResources::serializeObject(void)
 {
-  if (playerInfo || scn_plr_data_ver < 1.14f)
+  SerializationContext &ctx = getContext();
+
+  if (ctx.scn_player_info || ctx.scn_plr_data_ver < 1.14f)
     serialize<uint32_t>(state);
-  if (!playerInfo || scn_plr_data_ver < 1.14f)
+  if (!ctx.scn_player_info || ctx.scn_plr_data_ver < 1.14f)
   {
-    serialize<uint32_t>(gold);
-    serialize<uint32_t>(wood);
-    serialize<uint32_t>(food);
-    serialize<uint32_t>(stone);
+    serializeFields(gold, wood, food, stone);
   }
-  if (playerInfo || scn_plr_data_ver < 1.14f)
+  if (ctx.scn_player_info || ctx.scn_plr_data_ver < 1.14f)
   {
-    serialize<uint32_t>(type);
-    serialize<uint32_t>(civilizationID);
-    serialize<uint32_t>(unknown1);
+    serializeFields(type, civilizationID, unknown1);
   }
-  if (!playerInfo && scn_plr_data_ver > 1.16f)
+  if (!ctx.scn_player_info && ctx.scn_plr_data_ver > 1.16f)
   {
     serialize<uint32_t>(ore);
     serialize<uint32_t>(goods);
-    if (scn_plr_data_ver > 1.23f)
+    if (ctx.scn_plr_data_ver > 1.23f)
       serialize<uint32_t>(goods);
   }
 }
@@ -199,9 +195,7 @@ UnknownData1::~UnknownData1()
 
 void UnknownData1::serializeObject(void)
 {
-  serialize<int16_t>(unknownCount);
-  serialize<int16_t>(unknown2);
-  serialize<float>(unknown3);
+  serializeFields(unknownCount, unknown2, unknown3);
 
   /*/ 48 bytes? Lots of data if count is over 0
   ReadData((HANDLE)_hScenFile, hUnknown, 4u);
@@ -222,9 +216,7 @@ void ScnMainPlayerData::serializeBitmap(void)
 {
   serialize<uint32_t>(bitmapIncluded);
 
-  serialize<uint32_t>(bitmapWidth);
-  serialize<uint32_t>(bitmapHeigth);
-  serialize<int16_t>(unknown1);
+  serializeFields(bitmapWidth, bitmapHeigth, unknown1);
 
   if (bitmapIncluded == 0)
     return;
@@ -260,15 +252,17 @@ AiFile::~AiFile()
 
 void AiFile::serializeObject(void)
 {
+  SerializationContext &ctx = getContext();
+
   serializeSize<uint32_t>(aiFilenameSize, aiFilename, true);
   serializeSize<uint32_t>(cityFileSize, cityFilename, true);
-  if (scn_plr_data_ver > 1.07f)
+  if (ctx.scn_plr_data_ver > 1.07f)
     serializeSize<uint32_t>(perFileSize, perFilename, true);
 
   // crap in exe, says these are >= 1.15
   serialize(aiFilename, aiFilenameSize);
   serialize(cityFilename, cityFileSize);
-  if (scn_plr_data_ver > 1.07f)
+  if (ctx.scn_plr_data_ver > 1.07f)
     serialize(perFilename, perFileSize);
 }
 
@@ -282,20 +276,16 @@ ScnVictory::~ScnVictory()
 
 void ScnVictory::serializeObject(void)
 {
+  SerializationContext &ctx = getContext();
+
   {
-    serialize<uint32_t>(conquestRequired);
-    serialize<uint32_t>(unused1);
-    serialize<uint32_t>(numRelicsRequired);
-    serialize<uint32_t>(unused2);
-    serialize<uint32_t>(exploredPerCentRequired);
-    serialize<uint32_t>(unused3);
+    serializeFields(conquestRequired, unused1, numRelicsRequired, unused2,
+      exploredPerCentRequired, unused3);
   }
   serialize<uint32_t>(allConditionsRequired);
-  if (scn_plr_data_ver > 1.12f)
+  if (ctx.scn_plr_data_ver > 1.12f)
   {
-    serialize<uint32_t>(victoryMode);
-    serialize<uint32_t>(scoreRequired);
-    serialize<uint32_t>(timeForTimedGame);
+    serializeFields(victoryMode, scoreRequired, timeForTimedGame);
   }
 }
 
@@ -341,15 +331,17 @@ ScnDisables::~ScnDisables()
 
 void ScnDisables::serializeObject(void)
 {
-  if (scn_plr_data_ver > 1.17f)
+  SerializationContext &ctx = getContext();
+
+  if (ctx.scn_plr_data_ver > 1.17f)
     serialize<uint32_t>(numDisabledTechs, 16);
-  serialize<uint32_t>(disabledTechs, 16, scn_plr_data_ver < 1.04f ? 20 : scn_plr_data_ver < 1.3f ? 30 : 60);
-  if (scn_plr_data_ver > 1.17f)
+  serialize<uint32_t>(disabledTechs, 16, ctx.scn_plr_data_ver < 1.04f ? 20 : ctx.scn_plr_data_ver < 1.3f ? 30 : 60);
+  if (ctx.scn_plr_data_ver > 1.17f)
   {
     serialize<uint32_t>(numDisabledUnits, 16);
-    serialize<uint32_t>(disabledUnits, 16, scn_plr_data_ver < 1.3f ? 30 : 60);
+    serialize<uint32_t>(disabledUnits, 16, ctx.scn_plr_data_ver < 1.3f ? 30 : 60);
     serialize<uint32_t>(numDisabledBuildings, 16);
-    serialize<uint32_t>(disabledBuildings, 16, scn_plr_data_ver < 1.3f ? 20 : 60);
+    serialize<uint32_t>(disabledBuildings, 16, ctx.scn_plr_data_ver < 1.3f ? 20 : 60);
   }
 }
 
@@ -364,11 +356,8 @@ ScnMorePlayerData::~ScnMorePlayerData()
 void ScnMorePlayerData::serializeObject(void)
 {
   serializeForcedString<uint16_t>(playerName);
-  serialize<float>(initCameraX);
-  serialize<float>(initCameraY);
-  serialize<int16_t>(initCameraX2);
-  serialize<int16_t>(initCameraY2);
-  serialize<uint8_t>(alliedVictory);
+  serializeFields(initCameraX, initCameraY, initCameraX2, initCameraY2,
+    alliedVictory);
   serializeSize<int16_t>(playerCount_, diplomacy1.size());
   serialize<uint8_t>(diplomacy1, playerCount_);
   serialize<uint32_t>(diplomacy2, playerCount_);
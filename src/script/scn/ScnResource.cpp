@@ -36,17 +36,16 @@ ScnPlayerResources::~ScnPlayerResources()
 
 void ScnPlayerResources::serializeObject(void)
 {
-  serialize<float>(food);
-  serialize<float>(wood);
-  serialize<float>(gold);
-  serialize<float>(stone);
-  if (scn_internal_ver > 1.12f)
+  SerializationContext &ctx = getContext();
+
+  serializeFields(food, wood, gold, stone);
+  if (ctx.scn_internal_ver > 1.12f)
   {
     serialize<float>(ore);
-    if (scn_internal_ver < 1.3f)
+    if (ctx.scn_internal_ver < 1.3f)
       serialize<float>(goods);
   }
-  if (scn_internal_ver > 1.13f)
+  if (ctx.scn_internal_ver > 1.13f)
     serialize<float>(popLimit); // game forces range from 25 to 200, defaults to 75
 }
 
@@ -74,14 +73,13 @@ ScnUnit::~ScnUnit()
 
 void ScnUnit::serializeObject(void)
 {
-  serialize<float>(positionX);
-  serialize<float>(positionY);
-  serialize<float>(positionZ);
-  serialize<uint32_t>(spawnID);
+  SerializationContext &ctx = getContext();
+
+  serializeFields(positionX, positionY, positionZ, spawnID);
   serialize<int16_t>(objectID); // units with hardcoded behaviour 102, 66, 59, 768, 420, 770, 691
   serialize<uint8_t>(state);
   serialize<float>(rotation);
-  if (scn_ver != "1.14")
+  if (ctx.scn_ver != "1.14")
     serialize<int16_t>(initAnimationFrame);
   serialize<uint32_t>(garrisonedInID);
 }
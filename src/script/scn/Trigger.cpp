@@ -35,22 +35,21 @@ Trigger::~Trigger()
 
 void Trigger::serializeObject(void)
 {
-  serialize<int32_t>(startingState);
-  serialize<uint8_t>(looping);
-  serialize<int32_t>(stringTableID);
-  serialize<uint8_t>(isObjective);
-  serialize<int32_t>(descriptionOrder);
-  if (scn_trigger_ver > 1.5f)
+  SerializationContext &ctx = getContext();
+
+  serializeFields(startingState, looping, stringTableID, isObjective,
+    descriptionOrder);
+  if (ctx.scn_trigger_ver > 1.5f)
     serialize<int32_t>(startingTime);
   serializeForcedString<int32_t>(description);
   serializeForcedString<int32_t>(name);
   serializeSize<int32_t>(numEffects_, effects.size());
   serializeSub<TriggerEffect>(effects, numEffects_);
-  if (scn_trigger_ver > 1.2f)
+  if (ctx.scn_trigger_ver > 1.2f)
     serialize<int32_t>(effectDisplayOrder, numEffects_);
   serializeSize<int32_t>(numConditions_, conditions.size());
   serializeSub<TriggerCondition>(conditions, numConditions_);
-  if (scn_trigger_ver > 1.2f)
+  if (ctx.scn_trigger_ver > 1.2f)
     serialize<int32_t>(conditionDisplayOrder, numConditions_);
 }
 
@@ -64,8 +63,10 @@ TriggerCondition::~TriggerCondition()
 
 void TriggerCondition::serializeObject(void)
 {
+  SerializationContext &ctx = getContext();
+
   serialize<int32_t>(type);
-  if (scn_trigger_ver > 1.0f)
+  if (ctx.scn_trigger_ver > 1.0f)
   {
     if (isOperation(OP_WRITE)) // Automatic compression.
     {
@@ -96,8 +97,10 @@ TriggerEffect::~TriggerEffect()
 
 void TriggerEffect::serializeObject(void)
 {
+  SerializationContext &ctx = getContext();
+
   serialize<int32_t>(type);
-  if (scn_trigger_ver > 1.0f)
+  if (ctx.scn_trigger_ver > 1.0f)
   {
     if (isOperation(OP_WRITE)) // Automatic compression.
     {
@@ -118,7 +121,7 @@ void TriggerEffect::serializeObject(void)
   serialize<int32_t>(&start, usedVariables);
   serializeForcedString<int32_t>(message);
   serializeForcedString<int32_t>(soundFile);
-  if (scn_trigger_ver > 1.1f && usedVariables >= 5 && setObjects > 0)
+  if (ctx.scn_trigger_ver > 1.1f && usedVariables >= 5 && setObjects > 0)
     serialize<int32_t>(selectedUnits, setObjects);
 }
 
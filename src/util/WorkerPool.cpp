@@ -0,0 +1,196 @@
+/*
+    genieutils - A library for reading and writing data files of genie
+               engine games.
+    Copyright (C) 2011 - 2013  Armin Preiml
+    Copyright (C) 2011 - 2021  Mikko "Tapsa" P
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "genie/util/WorkerPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <system_error>
+
+namespace genie
+{
+
+//------------------------------------------------------------------------------
+/// One run() call. Workers hold it through the queue, so one that takes it
+/// after run() returned finds no items left and never calls the function.
+//
+struct WorkerPool::Job
+{
+  const std::function<void(size_t)> *function;
+  size_t count;
+
+  std::atomic<size_t> next{0};
+  std::atomic<bool> failed{false};
+
+  std::mutex mutex;
+  std::condition_variable finished;
+  size_t done = 0;
+  std::exception_ptr error;
+};
+
+//------------------------------------------------------------------------------
+WorkerPool::WorkerPool()
+{
+}
+
+//------------------------------------------------------------------------------
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+
+  queued_.notify_all();
+
+  for (std::thread &worker : workers_)
+  {
+    worker.join();
+  }
+}
+
+//------------------------------------------------------------------------------
+WorkerPool &WorkerPool::getGlobalPool(void)
+{
+  static WorkerPool pool;
+  return pool;
+}
+
+//------------------------------------------------------------------------------
+unsigned int WorkerPool::getThreadCount(void)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return static_cast<unsigned int>(workers_.size());
+}
+
+//------------------------------------------------------------------------------
+unsigned int WorkerPool::resolveThreadCount(unsigned int threadCount)
+{
+  if (threadCount == 0)
+    threadCount = std::thread::hardware_concurrency();
+
+  return std::max(threadCount, 1u);
+}
+
+//------------------------------------------------------------------------------
+void WorkerPool::run(size_t count, unsigned int threadCount,
+                     const std::function<void(size_t)> &job)
+{
+  if (count == 0)
+    return;
+
+  size_t helpers = std::min<size_t>(resolveThreadCount(threadCount) - 1,
+                                    count - 1);
+
+  std::shared_ptr<Job> shared = std::make_shared<Job>();
+  shared->function = &job;
+  shared->count = count;
+
+  if (helpers)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      while (workers_.size() < helpers)
+      {
+        try
+        {
+          workers_.emplace_back(&WorkerPool::workerLoop, this);
+        }
+        catch (const std::system_error &)
+        {
+          helpers = workers_.size();
+          break;
+        }
+      }
+
+      for (size_t i = 0; i < helpers; ++i)
+        queue_.push_back(shared);
+    }
+
+    if (helpers == 1)
+      queued_.notify_one();
+    else
+      queued_.notify_all();
+  }
+
+  work(*shared);
+
+  std::unique_lock<std::mutex> lock(shared->mutex);
+  shared->finished.wait(lock, [&] { return shared->done == count; });
+
+  if (shared->error)
+    std::rethrow_exception(shared->error);
+}
+
+//------------------------------------------------------------------------------
+void WorkerPool::workerLoop(void)
+{
+  while (true)
+  {
+    std::shared_ptr<Job> job;
+
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      queued_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+
+      if (queue_.empty())
+        return;
+
+      job = std::move(queue_.front());
+      queue_.pop_front();
+    }
+
+    work(*job);
+  }
+}
+
+//------------------------------------------------------------------------------
+void WorkerPool::work(Job &job)
+{
+  for (size_t i = job.next++; i < job.count; i = job.next++)
+  {
+    std::exception_ptr error;
+
+    if (!job.failed)
+    {
+      try
+      {
+        (*job.function)(i);
+      }
+      catch (...)
+      {
+        error = std::current_exception();
+        job.failed = true;
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(job.mutex);
+
+    if (error && !job.error)
+      job.error = error;
+
+    if (++job.done == job.count)
+      job.finished.notify_all();
+  }
+}
+
+}
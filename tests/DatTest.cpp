@@ -27,7 +27,7 @@
 
 const char * const DAT_PATH = "dat/";
 
-const char * getFileName(genie::GameVersion gv)
+std::string getFileName(genie::GameVersion gv)
 {
   std::string file_name(DAT_PATH);
   
@@ -43,21 +43,21 @@ const char * getFileName(genie::GameVersion gv)
     case genie::GV_None: break;
   }
   
-  return file_name.c_str();
+  return file_name;
 }
 
 genie::DatFile *openFile(genie::GameVersion gv)
 {
   genie::DatFile *df = new genie::DatFile();
   df->setGameVersion(gv);
-  df->load(getFileName(gv));
+  df->load(getFileName(gv).c_str());
 
   return df;
 }
 
 int readWriteDiff(genie::GameVersion gv)
 {
-  std::string fn = std::string(getFileName(gv));
+  std::string fn = getFileName(gv);
   std::string fn_or = fn + ".raw_orig";
   std::string fn_gc = fn + ".genie";
   std::string fn_gr = fn + ".raw_genie";
@@ -76,6 +76,26 @@ int readWriteDiff(genie::GameVersion gv)
   return binaryCompare(fn_or.c_str(), fn_gr.c_str());
 }
 
+int threadedSaveDiff(genie::GameVersion gv, bool share_units)
+{
+  std::string fn = getFileName(gv);
+  std::string fn_serial = fn + ".serial";
+  std::string fn_threaded = fn + ".threaded";
+
+  genie::DatFile file;
+  file.setGameVersion(gv);
+  file.setShareUnits(share_units);
+  file.load(fn.c_str());
+
+  file.setSaveThreadCount(1);
+  file.saveAs(fn_serial.c_str());
+
+  file.setSaveThreadCount(4);
+  file.saveAs(fn_threaded.c_str());
+
+  return binaryCompare(fn_serial.c_str(), fn_threaded.c_str());
+}
+
 BOOST_AUTO_TEST_CASE( simple_read_write_test )
 {
   BOOST_TEST_MESSAGE("Simple read write test...");
@@ -89,3 +109,17 @@ BOOST_AUTO_TEST_CASE( simple_read_write_test )
   BOOST_CHECK_EQUAL(readWriteDiff(genie::GV_CC), 0);
 }
 
+BOOST_AUTO_TEST_CASE( threaded_save_test )
+{
+  BOOST_TEST_MESSAGE("Threaded save test...");
+
+  for (bool share_units : {false, true})
+  {
+    BOOST_CHECK_EQUAL(threadedSaveDiff(genie::GV_AoE, share_units), 0);
+    BOOST_CHECK_EQUAL(threadedSaveDiff(genie::GV_RoR, share_units), 0);
+    BOOST_CHECK_EQUAL(threadedSaveDiff(genie::GV_AoK, share_units), 0);
+    BOOST_CHECK_EQUAL(threadedSaveDiff(genie::GV_TC, share_units), 0);
+    BOOST_CHECK_EQUAL(threadedSaveDiff(genie::GV_SWGB, share_units), 0);
+    BOOST_CHECK_EQUAL(threadedSaveDiff(genie::GV_CC, share_units), 0);
+  }
+}
@@ -0,0 +1,456 @@
+/*
+    genieutils - A library for reading and writing data files of genie
+               engine games.
+    Copyright (C) 2011 - 2013  Armin Preiml
+    Copyright (C) 2011 - 2021  Mikko "Tapsa" P
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define BOOST_TEST_MODULE slp_frame_test
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+#include <ios>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "genie/resource/SlpFile.h"
+
+namespace
+{
+
+const uint16_t TRANSPARENT_ROW = 0x8000;
+
+struct FrameSize
+{
+  uint32_t width;
+  uint32_t height;
+};
+
+//------------------------------------------------------------------------------
+/// Image decoded by the reference decoder.
+//
+struct Reference
+{
+  std::vector<uint8_t> pixel_indexes;
+  std::vector<uint8_t> alpha_channel;
+  std::vector<genie::XY16> shadow_mask;
+  std::vector<genie::XY16> shield_mask;
+  std::vector<genie::XY16> outline_pc_mask;
+  std::vector<genie::Color8XY16> player_color_mask;
+};
+
+template <typename T>
+void put(std::string &data, size_t pos, T value)
+{
+  memcpy(&data[pos], &value, sizeof(T));
+}
+
+template <typename T>
+T get(const std::string &data, size_t pos)
+{
+  T value;
+  memcpy(&value, &data[pos], sizeof(T));
+  return value;
+}
+
+//------------------------------------------------------------------------------
+void pushCount(std::string &cmds, uint8_t cmd, uint32_t count)
+{
+  if (count < 16)
+  {
+    cmds += static_cast<char>(cmd | count << 4);
+  }
+  else
+  {
+    cmds += static_cast<char>(cmd);
+    cmds += static_cast<char>(count);
+  }
+}
+
+//------------------------------------------------------------------------------
+/// Random commands of one 8 bit row, each staying within the row.
+//
+std::string randomRow(std::mt19937 &rng, uint32_t width, bool decay,
+                      bool visible, uint16_t &left, uint16_t &right)
+{
+  auto random = [&](uint32_t lo, uint32_t hi) {
+    return std::uniform_int_distribution<uint32_t>(lo, hi)(rng);
+  };
+  auto pixels = [&](std::string &cmds, uint32_t count) {
+    for (uint32_t i = 0; i < count * (decay ? 2 : 1); ++i)
+      cmds += static_cast<char>(random(0, 255));
+  };
+
+  std::string cmds;
+
+  if (!visible && random(0, 11) == 0)
+  {
+    left = right = TRANSPARENT_ROW;
+    return std::string(1, 0x0F);
+  }
+
+  left = random(0, width / 3);
+  uint32_t pos = left;
+
+  while (pos < width && random(0, 9) != 0)
+  {
+    uint32_t count = random(1, std::min<uint32_t>(width - pos, 255));
+
+    switch (random(0, 11))
+    {
+      case 0: // Lesser block copy
+        count = std::min<uint32_t>(count, 63);
+        cmds += static_cast<char>(count << 2);
+        pixels(cmds, count);
+        break;
+      case 1: // Lesser skip
+        count = std::min<uint32_t>(count, 63);
+        cmds += static_cast<char>(count << 2 | 1);
+        break;
+      case 2: // Greater block copy
+        cmds += static_cast<char>(0x02 | (count >> 8) << 4);
+        cmds += static_cast<char>(count & 0xFF);
+        pixels(cmds, count);
+        break;
+      case 3: // Greater skip
+        cmds += static_cast<char>(0x03 | (count >> 8) << 4);
+        cmds += static_cast<char>(count & 0xFF);
+        break;
+      case 4: // Player color copy
+        pushCount(cmds, 0x06, count);
+        pixels(cmds, count);
+        break;
+      case 5: // Fill
+        pushCount(cmds, 0x07, count);
+        pixels(cmds, 1);
+        break;
+      case 6: // Player color fill
+        pushCount(cmds, 0x0A, count);
+        pixels(cmds, 1);
+        break;
+      case 7: // Shadow
+        pushCount(cmds, 0x0B, count);
+        break;
+      case 8: // Single outline or shield pixel
+        count = 1;
+        cmds += static_cast<char>(random(0, 1) ? 0x4E : 0x6E);
+        break;
+      default: // Outline or shield span
+        cmds += static_cast<char>(random(0, 1) ? 0x5E : 0x7E);
+        cmds += static_cast<char>(count);
+        break;
+    }
+    pos += count;
+  }
+
+  right = width - pos;
+  cmds += static_cast<char>(0x0F);
+  return cmds;
+}
+
+//------------------------------------------------------------------------------
+/// Builds a version 2.0 slp of random 8 bit frames.
+//
+std::string randomSlp(uint32_t seed, const std::vector<FrameSize> &sizes,
+                      bool decay)
+{
+  std::mt19937 rng(seed);
+
+  std::string slp(32 + 32 * sizes.size(), '\0');
+  memcpy(&slp[0], "2.0N", 4);
+  put<uint16_t>(slp, 4, sizes.size());
+  put<uint16_t>(slp, 6, decay ? 32 : 16);
+
+  for (size_t i = 0; i < sizes.size(); ++i)
+  {
+    uint32_t width = sizes[i].width;
+    uint32_t height = sizes[i].height;
+    size_t header = 32 + 32 * i;
+    size_t outline = slp.size();
+    size_t table = outline + 4 * height;
+
+    slp.resize(table + 4 * height);
+
+    put<uint32_t>(slp, header, table);
+    put<uint32_t>(slp, header + 4, outline);
+    put<uint32_t>(slp, header + 12, 0x10);
+    put<uint32_t>(slp, header + 16, width);
+    put<uint32_t>(slp, header + 20, height);
+
+    for (uint32_t row = 0; row < height; ++row)
+    {
+      uint16_t left, right;
+      // The last row is visible, so cutting the data short breaks it.
+      std::string cmds = randomRow(rng, width, decay, row + 1 == height,
+                                   left, right);
+
+      put<uint16_t>(slp, outline + 4 * row, left);
+      put<uint16_t>(slp, outline + 4 * row + 2, right);
+      put<uint32_t>(slp, table + 4 * row, slp.size());
+      slp += cmds;
+    }
+  }
+
+  return slp;
+}
+
+//------------------------------------------------------------------------------
+/// Decodes a frame one command byte at a time, the way SlpFrame did before
+/// it decoded rows in place.
+//
+Reference decodeReference(const std::string &slp, uint16_t frame)
+{
+  bool decay = get<uint16_t>(slp, 6) == 32;
+  size_t header = 32 + 32 * frame;
+  uint32_t table = get<uint32_t>(slp, header);
+  uint32_t outline = get<uint32_t>(slp, header + 4);
+  uint32_t width = get<uint32_t>(slp, header + 16);
+  uint32_t height = get<uint32_t>(slp, header + 20);
+
+  Reference ref;
+  ref.pixel_indexes.resize(width * height);
+  ref.alpha_channel.resize(width * height, 0);
+
+  for (uint32_t row = 0; row < height; ++row)
+  {
+    uint16_t left = get<uint16_t>(slp, outline + 4 * row);
+    uint16_t right = get<uint16_t>(slp, outline + 4 * row + 2);
+    if (left == TRANSPARENT_ROW || right == TRANSPARENT_ROW)
+      continue;
+
+    size_t pos = get<uint32_t>(slp, table + 4 * row);
+    auto next = [&]() { return static_cast<uint8_t>(slp.at(pos++)); };
+    auto count = [&](uint8_t data) -> uint32_t {
+      return data >> 4 ? data >> 4 : next();
+    };
+    auto mask = [&](std::vector<genie::XY16> &to, uint32_t &col, uint32_t n) {
+      for (uint32_t i = 0; i < n; ++i, ++col)
+        to.emplace_back(col, row);
+    };
+    auto copy = [&](uint32_t &col, uint32_t n, bool player) {
+      for (uint32_t i = 0; i < n; ++i, ++col)
+      {
+        if (decay)
+          next();
+        uint8_t index = next();
+        ref.pixel_indexes[row * width + col] = index;
+        ref.alpha_channel[row * width + col] = 255;
+        if (player)
+          ref.player_color_mask.emplace_back(col, row, index);
+      }
+    };
+    auto fill = [&](uint32_t &col, uint32_t n, bool player) {
+      if (decay)
+        next();
+      uint8_t index = next();
+      for (uint32_t i = 0; i < n; ++i, ++col)
+      {
+        ref.pixel_indexes[row * width + col] = index;
+        ref.alpha_channel[row * width + col] = 255;
+        if (player)
+          ref.player_color_mask.emplace_back(col, row, index);
+      }
+    };
+
+    uint32_t col = left;
+    for (uint8_t data = next(); data != 0x0F; data = next())
+    {
+      switch (data & 0x0F)
+      {
+        case 0x0: case 0x4: case 0x8: case 0xC:
+          copy(col, data >> 2, false);
+          break;
+        case 0x1: case 0x5: case 0x9: case 0xD:
+          col += data >> 2;
+          break;
+        case 0x2:
+          copy(col, ((data & 0xF0) << 4) + next(), false);
+          break;
+        case 0x3:
+          col += ((data & 0xF0) << 4) + next();
+          break;
+        case 0x6:
+          copy(col, count(data), true);
+          break;
+        case 0x7:
+          fill(col, count(data), false);
+          break;
+        case 0xA:
+          fill(col, count(data), true);
+          break;
+        case 0xB:
+          mask(ref.shadow_mask, col, count(data));
+          break;
+        default:
+          switch (data)
+          {
+            case 0x4E: mask(ref.outline_pc_mask, col, 1); break;
+            case 0x6E: mask(ref.shield_mask, col, 1); break;
+            case 0x5E: mask(ref.outline_pc_mask, col, next()); break;
+            case 0x7E: mask(ref.shield_mask, col, next()); break;
+            default: BOOST_FAIL("Unexpected command in generated slp");
+          }
+      }
+    }
+  }
+
+  return ref;
+}
+
+//------------------------------------------------------------------------------
+void loadSlp(genie::SlpFile &file, const std::string &slp,
+             unsigned int threads, bool lazy = false)
+{
+  std::istringstream stream(slp);
+  file.setLazyLoading(lazy);
+  file.setDecodeThreadCount(threads);
+  file.readObject(stream);
+}
+
+bool sameXY(const std::vector<genie::XY16> &a,
+            const std::vector<genie::XY16> &b)
+{
+  if (a.size() != b.size())
+    return false;
+
+  for (size_t i = 0; i < a.size(); ++i)
+  {
+    if (a[i].x != b[i].x || a[i].y != b[i].y)
+      return false;
+  }
+  return true;
+}
+
+bool sameColorXY(const std::vector<genie::Color8XY16> &a,
+                 const std::vector<genie::Color8XY16> &b)
+{
+  if (a.size() != b.size())
+    return false;
+
+  for (size_t i = 0; i < a.size(); ++i)
+  {
+    if (a[i].x != b[i].x || a[i].y != b[i].y || a[i].index != b[i].index)
+      return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void checkAgainstReference(const std::string &slp, unsigned int threads,
+                           bool lazy = false)
+{
+  genie::SlpFile file;
+  loadSlp(file, slp, threads, lazy);
+
+  for (uint16_t i = 0; i < file.getFrameCount(); ++i)
+  {
+    Reference ref = decodeReference(slp, i);
+    const genie::SlpFrameData &img = file.getFrame(i)->img_data;
+
+    BOOST_CHECK(img.pixel_indexes == ref.pixel_indexes);
+    BOOST_CHECK(img.alpha_channel == ref.alpha_channel);
+    BOOST_CHECK(sameXY(img.shadow_mask, ref.shadow_mask));
+    BOOST_CHECK(sameXY(img.shield_mask, ref.shield_mask));
+    BOOST_CHECK(sameXY(img.outline_pc_mask, ref.outline_pc_mask));
+    BOOST_CHECK(sameColorXY(img.player_color_mask, ref.player_color_mask));
+  }
+}
+
+// Frames tall enough to be split over several threads.
+const std::vector<FrameSize> TALL_FRAMES = {{150, 700}, {90, 300}};
+
+const std::vector<FrameSize> SMALL_FRAMES = {
+  {1, 1}, {37, 20}, {180, 64}, {64, 130}, {255, 9}
+};
+
+}
+
+BOOST_AUTO_TEST_CASE( decode_matches_reference )
+{
+  for (uint32_t seed = 1; seed <= 4; ++seed)
+  {
+    checkAgainstReference(randomSlp(seed, SMALL_FRAMES, false), 1);
+    checkAgainstReference(randomSlp(seed, SMALL_FRAMES, true), 1);
+    checkAgainstReference(randomSlp(seed, SMALL_FRAMES, false), 1, true);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( row_ranges_match_reference )
+{
+  for (uint32_t seed = 1; seed <= 4; ++seed)
+  {
+    // More threads than frames, so rows of each frame are split.
+    checkAgainstReference(randomSlp(seed, TALL_FRAMES, false), 8);
+    checkAgainstReference(randomSlp(seed, TALL_FRAMES, true), 8);
+    checkAgainstReference(randomSlp(seed, {{200, 900}}, false), 5);
+    checkAgainstReference(randomSlp(seed, SMALL_FRAMES, false), 0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( truncated_commands_throw )
+{
+  std::string slp = randomSlp(7, TALL_FRAMES, false);
+
+  // Cuts off the end of the last row, including its end command.
+  std::string truncated = slp.substr(0, slp.size() - 1);
+
+  for (unsigned int threads : {1u, 8u})
+  {
+    genie::SlpFile file;
+    BOOST_CHECK_THROW(loadSlp(file, truncated, threads),
+                      std::ios_base::failure);
+  }
+
+  genie::SlpFile lazy;
+  loadSlp(lazy, truncated, 1, true);
+  BOOST_CHECK_NO_THROW(lazy.getFrame(0));
+  BOOST_CHECK_THROW(lazy.getFrame(1), std::ios_base::failure);
+  BOOST_CHECK_THROW(lazy.getFrame(1), std::ios_base::failure);
+}
+
+BOOST_AUTO_TEST_CASE( corrupt_commands_throw )
+{
+  std::string slp = randomSlp(8, TALL_FRAMES, false);
+  uint32_t table = get<uint32_t>(slp, 32);
+  uint32_t outline = get<uint32_t>(slp, 32 + 4);
+
+  // Points the commands of the first visible row past the data.
+  std::string past_end = slp;
+  uint32_t row = 0;
+  while (get<uint16_t>(slp, outline + 4 * row) == TRANSPARENT_ROW)
+    ++row;
+  put<uint32_t>(past_end, table + 4 * row, slp.size() + 100);
+
+  // Drops the end command of the last row, so it runs into the end.
+  std::string no_end = slp;
+  no_end.back() = 0x01;
+
+  // Moves the command table of the second frame past the data.
+  std::string bad_table = slp;
+  put<uint32_t>(bad_table, 64, slp.size() - 2);
+
+  for (const std::string *corrupt : {&past_end, &no_end, &bad_table})
+  {
+    for (unsigned int threads : {1u, 8u})
+    {
+      genie::SlpFile file;
+      BOOST_CHECK_THROW(loadSlp(file, *corrupt, threads),
+                        std::ios_base::failure);
+    }
+  }
+}
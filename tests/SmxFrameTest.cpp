@@ -0,0 +1,88 @@
+/*
+    genieutils - A library for reading and writing data files of genie
+               engine games.
+    Copyright (C) 2011 - 2013  Armin Preiml
+    Copyright (C) 2011 - 2021  Mikko "Tapsa" P
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define BOOST_TEST_MODULE smx_frame_test
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+#include <vector>
+
+#include "genie/resource/SmxFrame.h"
+
+typedef genie::SmxFrame::Unpacker4Plus1 Unpacker;
+
+// Written past the last pixel, kernels must leave it alone.
+const uint16_t GUARD = 0xBEEF;
+
+BOOST_AUTO_TEST_CASE( unpack_4plus1_kernels_match_scalar )
+{
+  std::vector<Unpacker> unpackers = genie::SmxFrame::get4Plus1Unpackers();
+
+  BOOST_REQUIRE(!unpackers.empty());
+  const Unpacker &scalar = unpackers.front();
+
+  for (const Unpacker &unpacker : unpackers)
+    BOOST_TEST_MESSAGE("4plus1 kernel: " << unpacker.name);
+
+  std::mt19937 rng(4);
+  std::uniform_int_distribution<int> byte(0, 255);
+
+  // Every tail length of the 2 and 4 block vector steps, and longer runs.
+  std::vector<size_t> block_counts;
+  for (size_t count = 0; count <= 40; ++count)
+    block_counts.push_back(count);
+  for (size_t count : {255, 256, 257, 1021, 1022, 1023, 1024, 4099})
+    block_counts.push_back(count);
+
+  for (size_t block_count : block_counts)
+  {
+    // Sized exactly, so a kernel reading past the input trips sanitizers.
+    std::vector<uint8_t> packed(5 * block_count);
+    for (uint8_t &value : packed)
+      value = static_cast<uint8_t>(byte(rng));
+
+    std::vector<uint16_t> expected(4 * block_count + 1, GUARD);
+    scalar.unpack(packed.data(), block_count, expected.data());
+    BOOST_REQUIRE_EQUAL(expected.back(), GUARD);
+
+    for (const Unpacker &unpacker : unpackers)
+    {
+      std::vector<uint16_t> pixels(4 * block_count + 1, GUARD);
+      unpacker.unpack(packed.data(), block_count, pixels.data());
+
+      BOOST_CHECK_MESSAGE(pixels == expected, unpacker.name <<
+        " differs from scalar for " << block_count << " blocks");
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( unpack_4plus1_scalar_layout )
+{
+  // Low bytes 0x10-0x13, high bits 0, 1, 2 and 3 from the lowest bits up.
+  const uint8_t packed[] = {0x10, 0x11, 0x12, 0x13, 0xE4};
+  uint16_t pixels[4];
+
+  genie::SmxFrame::get4Plus1Unpackers().front().unpack(packed, 1, pixels);
+
+  BOOST_CHECK_EQUAL(pixels[0], 0x010);
+  BOOST_CHECK_EQUAL(pixels[1], 0x111);
+  BOOST_CHECK_EQUAL(pixels[2], 0x212);
+  BOOST_CHECK_EQUAL(pixels[3], 0x313);
+}